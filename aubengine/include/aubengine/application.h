@@ -1,29 +1,96 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include "aubengine/frame_limiter.h"
 #include "aubengine/render_api.h"
 #include "aubengine/window.h"
 
 namespace Aubengine {
+// How well the simulation keeps up with wall time.
+struct SimulationStats {
+  uint64_t ticks = 0;
+  // simulation time given up, by the lag clamp or the catch-up cap, rather
+  // than simulated late
+  uint64_t dropped_ticks = 0;
+  uint64_t dropped_nanoseconds = 0;
+  // frames that hit the catch-up cap
+  uint64_t overloaded_frames = 0;
+  // update rate in use, below the requested one while adaptive mode backs off
+  uint32_t update_rate = 0;
+};
+
+// How the main loop spent the time it had no work for.
+struct FramePacingStats {
+  uint64_t frames = 0;
+  // time asleep, i.e. CPU time saved over spinning, and time spun to wake up
+  // on time
+  uint64_t slept_nanoseconds = 0;
+  uint64_t spun_nanoseconds = 0;
+};
+
 class Application {
  public:
   virtual ~Application() = default;
 
   static Application& GetInstance();
 
+  // ticks per second, the default rate meaning 0 as well
+  static constexpr uint32_t kDefaultUpdateRate = 60;
   Application& SetUpdateRate(uint32_t hz);
+  // Caps the ticks run back to back to catch up after a hitch, 0 meaning no
+  // cap; the lag beyond it is dropped instead of simulated.
+  Application& SetMaxCatchUpSteps(uint32_t steps);
+  // Caps the lag carried into a frame, 0 meaning no cap; a longer stall (a
+  // debugger break, a blocking load) is dropped instead of simulated.
+  Application& SetMaxLag(uint64_t nanoseconds);
+  // Under sustained overload, lowers the update rate step by step down to
+  // min_hz, and raises it back towards the requested rate once ticks are
+  // cheap again.
+  Application& SetAdaptiveUpdateRate(bool enabled, uint32_t min_hz);
+  SimulationStats GetSimulationStats();
+  // Caps rendering at fps frames per second, independently of the update
+  // rate, 0 (the default) meaning render as often as possible. Between
+  // frames and ticks the loop sleeps instead of spinning.
+  Application& SetTargetFrameRate(uint32_t fps);
+  FramePacingStats GetFramePacingStats();
+  // Runs the simulation on a thread of its own, while the main thread polls
+  // events and renders from the render state the simulation publishes after
+  // every tick. Frame time then becomes the longer of the two instead of
+  // their sum. Takes effect at the next Run.
+  Application& SetThreadedSimulation(bool enabled);
+  // Renders every window with a context from a thread of its own, which
+  // keeps that context current for the whole run. Windows are then drawn in
+  // parallel and presented without one's VSync wait holding up the others,
+  // and contexts never move between threads mid-frame. Each context draws
+  // with programs linked for it alone, as uniforms set on a program shared
+  // by windows drawing at once would race. Events are still pumped once a
+  // frame on the main thread. Takes effect at the next Run.
+  Application& SetRenderThreads(bool enabled);
   uint64_t MillisecondsPerUpdate();
   uint64_t NanosecondsPerUpdate();
   void Run(uint32_t hz);
   void Run();
+  // makes Run return after the current frame, from any thread
+  void Quit();
   Window* CreateWindowOpenGL();
+  // creates a window of the RenderAPI::NONE backend, which simulates its
+  // scene without drawing it
+  Window* CreateWindowNull();
+  // true when no window has a graphics context, i.e. there is nothing to draw
+  bool IsHeadless();
 
   void PollInput();
   void PhysicsUpdate();
   void Update();
-  void Render();
+  void Render(float alpha);
 
  public:
   Application(Application const&) = delete;
@@ -32,11 +99,76 @@ class Application {
  private:
   Application() = default;
 
+  // A thread that holds one window's context and runs the jobs handed to
+  // it, one at a time.
+  struct RenderThread {
+    Window* window = nullptr;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::function<void()> job;
+    bool busy = false;
+    bool stopping = false;
+  };
+
+  void RunSingleThreaded();
+  void RunThreaded();
+  void StartRenderThreads();
+  void StopRenderThreads();
+  void RunRenderThread(RenderThread& renderThread);
+  void Dispatch(RenderThread& renderThread, std::function<void()> job);
+  void Wait(RenderThread& renderThread);
+  // pumps window events, once for all windows
+  void PollWindowEvents();
+  // on a thread with a context: the main thread, or the first render thread
+  void UpdateResources();
+  bool ShouldClose();
+  // runs the ticks lag accounts for, within the catch-up budget
+  void CatchUp(uint64_t& lag, bool pollWindowEvents);
+  // called after each catch-up with the ticks it ran and their mean cost
+  void AdaptUpdateRate(uint32_t ticks, uint64_t nanosecondsPerTick);
+  // time left until the next tick is due, with lag already accrued
+  std::chrono::nanoseconds UntilNextTick(uint64_t lag);
+  // counts a rendered frame, records its duration and closes the metrics
+  // frame
+  void FinishFrame();
+  // deadline of the frame after the one due at deadline, under the target
+  // frame rate
+  std::chrono::steady_clock::time_point NextFrameDeadline(
+      std::chrono::steady_clock::time_point deadline,
+      std::chrono::steady_clock::time_point now);
+
  public:
   std::vector<std::shared_ptr<Window>> windows;
   Window* focused_window = nullptr;
 
  private:
-  uint32_t hz_ = 0;
+  // rate in use, which adaptive mode may lower below the requested one
+  // never 0, since the tick length is divided by it
+  std::atomic<uint32_t> hz_ = kDefaultUpdateRate;
+  uint32_t requested_hz_ = kDefaultUpdateRate;
+  bool threaded_simulation_ = false;
+  bool render_threads_enabled_ = false;
+  std::vector<std::unique_ptr<RenderThread>> render_threads_;
+  std::atomic<bool> quit_ = false;
+
+  uint32_t max_catch_up_steps_ = 5;
+  uint64_t max_lag_ = 250000000;
+
+  bool adaptive_update_rate_ = false;
+  uint32_t min_hz_ = 1;
+  double average_tick_nanoseconds_ = 0;
+  uint64_t ticks_since_rate_change_ = 0;
+
+  SimulationStats stats_;
+  std::mutex stats_mutex_;
+
+  uint32_t target_fps_ = 0;
+  std::atomic<uint64_t> frames_ = 0;
+  std::chrono::steady_clock::time_point last_frame_end_;
+  // one per thread that waits: the main thread, and the simulation thread
+  // in threaded mode
+  FrameLimiter frame_limiter_;
+  FrameLimiter simulation_limiter_;
 };
 }  // namespace Aubengine
\ No newline at end of file
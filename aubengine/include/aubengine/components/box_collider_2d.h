@@ -3,18 +3,21 @@
 #include <glm/glm.hpp>
 
 #include "aubengine/application.h"
-#include "aubengine/components/component.h"
+#include "aubengine/components/collider_2d.h"
 #include "box2d/box2d.h"
 
-class BoxCollider2D : public Component {
+class BoxCollider2D : public Collider2D {
  public:
   BoxCollider2D();
   BoxCollider2D(glm::vec3 size);
 
  public:
+  // relative to the size of the Transform
   glm::vec3 size{};
 
  public:
-  virtual void Start() override;
   virtual void Update() override;
+
+ protected:
+  virtual void BuildShapes() override;
 };
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "aubengine/components/collider_2d.h"
+
+class CircleCollider2D : public Collider2D {
+ public:
+  CircleCollider2D();
+  CircleCollider2D(float radius);
+
+ public:
+  // relative to the width of the Transform, so 0.5 fits a square sprite
+  float radius = 0.5f;
+  // of the center from the object's position, relative to its size
+  glm::vec2 offset{};
+
+ protected:
+  virtual void BuildShapes() override;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "aubengine/components/component.h"
+#include "box2d/box2d.h"
+
+// Base of the colliders: attaches the fixtures a collider builds to the
+// object's body in Start, and takes them off again when the collider is
+// removed while the body stays.
+class Collider2D : public Component {
+ public:
+  virtual ~Collider2D();
+
+  virtual void Start() override;
+
+ public:
+  // a sensor: reports contacts, but nothing collides with it
+  bool is_trigger = false;
+  float density = 1.0f;
+  float friction = 0.3f;
+
+ protected:
+  // adds the collider's shapes, in body space, through AddShape
+  virtual void BuildShapes() = 0;
+  void AddShape(const b2Shape& shape);
+
+  // Polygons are baked once per distinct set of vertices and copied out of
+  // a bounded cache, as computing the hull and mass data of a polygon is
+  // most of what building one costs and level objects tend to come in a
+  // handful of sizes.
+  static b2PolygonShape BakedBox(float halfWidth, float halfHeight);
+  static b2PolygonShape BakedPolygon(std::span<const b2Vec2> points);
+
+ private:
+  // the fixtures, and the body they were attached to, if any
+  std::vector<b2Fixture*> fixtures_;
+  b2Body* body_ = nullptr;
+};
@@ -1,6 +1,15 @@
 #pragma once
 
 class GameObject;
+class SnapshotReader;
+class SnapshotWriter;
+
+// the other side of a contact, as seen by one of the two objects
+struct Collision2D {
+  GameObject* other = nullptr;
+  // one of the fixtures is a sensor, so the objects overlap without colliding
+  bool is_trigger = false;
+};
 
 class Component {
  public:
@@ -8,6 +17,14 @@ class Component {
   virtual void Start() {}
   virtual void PhysicsUpdate() {}
   virtual void Update() {}
+  // Called at the start of the tick after the step the bodies began or
+  // ceased to touch in, before PhysicsUpdate.
+  virtual void OnCollisionEnter(const Collision2D&) {}
+  virtual void OnCollisionExit(const Collision2D&) {}
+  // Rollback: a component with simulation state of its own writes it here
+  // and reads it back, in the same order, when the scene is rolled back.
+  virtual void SaveState(SnapshotWriter&) const {}
+  virtual void LoadState(SnapshotReader&) {}
 
   virtual ~Component() = default;
 
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "aubengine/components/collider_2d.h"
+
+class PolygonCollider2D : public Collider2D {
+ public:
+  PolygonCollider2D(std::vector<glm::vec2> points);
+
+ public:
+  // Vertices of a convex polygon, relative to the size of the Transform.
+  // Box2D polygons have at most b2_maxPolygonVertices vertices, so larger
+  // ones are split into a fan of pieces sharing the first vertex.
+  std::vector<glm::vec2> points;
+
+ protected:
+  virtual void BuildShapes() override;
+};
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <vector>
 
 #include "aubengine/application.h"
 #include "aubengine/components/component.h"
+#include "aubengine/physics_world.h"
 #include "box2d/box2d.h"
 
 class RigidBody2D : public Component {
@@ -21,14 +23,41 @@ class RigidBody2D : public Component {
  public:
   RigidBody2D();
   RigidBody2D(BodyType body_type);
+  ~RigidBody2D();
 
   virtual void Start() override;
-  virtual void PhysicsUpdate() override;
   virtual void Update() override;
-
-  static void ChangeGravity(const b2Vec2& gravity);
-  void HandleNewCollider(const b2FixtureDef& fixtureDef);
-
- public:
-  static b2World world;
-};
\ No newline at end of file
+  virtual void SaveState(SnapshotWriter& writer) const override;
+  virtual void LoadState(SnapshotReader& reader) override;
+
+  // gravity of the world of the body's scene
+  void ChangeGravity(const b2Vec2& gravity);
+  b2Fixture* HandleNewCollider(const b2FixtureDef& fixtureDef);
+  void HandleRemovedCollider(b2Fixture* fixture);
+  // Takes the body out of the simulation and back, keeping it and its
+  // fixtures, for objects kept in a pool rather than destroyed.
+  void SetEnabled(bool enabled);
+  // Lets go of the body without destroying it, for when the whole world is
+  // about to go away; everything below is a no-op from then on.
+  void Detach();
+
+  // Changes to the body are queued and take effect at the next step, which
+  // may be running while they are made.
+  void SetLinearVelocity(const b2Vec2& velocity);
+  void ApplyForce(const b2Vec2& force);
+  void ApplyLinearImpulse(const b2Vec2& impulse);
+  // Two-way sync with the Transform. Pull copies the body's pose in if a
+  // step moved the body since the last sync; Push queues the Transform as
+  // the body's pose only if game code changed it since the last sync, as
+  // setting the pose of a body re-synchronizes its broadphase proxies.
+  void PullTransform();
+  void PushTransform(std::vector<PhysicsCommand>& commands);
+
+ private:
+  // world of the scene the body was created in
+  PhysicsWorld* world_ = nullptr;
+  // the Transform as of the last sync in either direction
+  glm::vec3 synced_position_{};
+  glm::vec3 synced_rotation_{};
+  uint64_t synced_revision_ = 0;
+};
@@ -21,8 +21,10 @@ class SpriteRenderer2D : public Component {
   std::shared_ptr<Shader> shader_ = nullptr;
   std::shared_ptr<Texture2D> texture_2d_ = nullptr;
   glm::vec3 color_ = {1, 1, 1};
+  // cached layer of the scene to draw into, see Scene::CreateCachedLayer; -1
+  // (the default) draws the sprite every frame
+  int32_t layer_ = -1;
+  // context of the scene's window; the quad drawn is shared by all sprites
+  // and owned by the SpriteRenderer
   GladGLContext* context_ = nullptr;
-  unsigned int quad_vao_ = 0;
-  unsigned int quad_ebo_ = 0;
-  unsigned int quad_vbo_ = 0;
 };
\ No newline at end of file
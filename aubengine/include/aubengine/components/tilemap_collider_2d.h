@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "aubengine/components/collider_2d.h"
+
+// Collides with the solid tiles of a grid through a few chain loops tracing
+// the outlines of the solid areas, rather than a fixture per tile, so a large
+// level costs about one fixture per island and hole. The outlines are baked
+// the first time the collider is started.
+//
+// Chains are one-sided and collide from outside the solid areas only, which
+// suits static level geometry: a body placed inside a wall is not pushed out.
+class TilemapCollider2D : public Collider2D {
+ public:
+  TilemapCollider2D(uint32_t width, uint32_t height, float tile_size,
+                    std::vector<uint8_t> tiles);
+
+  // outside the grid, tiles are empty
+  bool IsSolid(int32_t x, int32_t y) const;
+  size_t GetLoopCount() const { return loops_.size(); }
+
+ public:
+  uint32_t width = 0;
+  uint32_t height = 0;
+  float tile_size = 1.0f;
+  // row by row, bottom row first, nonzero meaning solid; the bottom left
+  // corner of the grid is at the object's position; width * height of them,
+  // which the constructor pads with empty tiles or truncates to
+  std::vector<uint8_t> tiles;
+
+ protected:
+  virtual void BuildShapes() override;
+
+ private:
+  void Bake();
+
+  std::vector<std::vector<b2Vec2>> loops_;
+  bool baked_ = false;
+};
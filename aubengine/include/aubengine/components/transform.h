@@ -9,7 +9,24 @@ class Transform : public Component {
   glm::vec3 position{};
   glm::vec3 size{};
   glm::vec3 euler_rotation{};
+  // state at the start of the current tick, which rendering interpolates
+  // from
+  glm::vec3 previous_position{};
+  glm::vec3 previous_euler_rotation{};
 
  public:
+  virtual void PhysicsUpdate() override;
   virtual void Update() override;
-};
\ No newline at end of file
+  virtual void SaveState(SnapshotWriter& writer) const override;
+  virtual void LoadState(SnapshotReader& reader) override;
+
+  // blend of the previous and current state, alpha being the fraction of a
+  // tick that elapsed since the current one was simulated
+  glm::vec3 InterpolatedPosition(float alpha) const;
+  glm::vec3 InterpolatedEulerRotation(float alpha) const;
+
+ private:
+  // false until the first tick, so that a freshly spawned object is not
+  // drawn sliding in from the origin
+  bool has_previous_ = false;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports the watched files that changed on disk since the previous Poll.
+// On Linux changes are delivered by inotify; elsewhere the modification time
+// of every watched file is compared on each Poll.
+class FileWatcher {
+ public:
+  FileWatcher();
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher&) = delete;
+  void operator=(const FileWatcher&) = delete;
+
+  // starts watching a file; returns its canonical path, which is also the
+  // form Poll reports it in
+  std::string Watch(const std::string& path);
+  // returns every watched file modified since the last call, once each
+  std::vector<std::string> Poll();
+
+ private:
+  std::unordered_map<std::string, std::filesystem::file_time_type>
+      write_times_;
+#ifdef __linux__
+  int inotify_fd_ = -1;
+  // inotify watch descriptor -> watched directory
+  std::unordered_map<int, std::string> directories_;
+#endif
+};
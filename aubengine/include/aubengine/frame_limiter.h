@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Waits for a deadline without burning a core: sleeps through most of the
+// wait, then spins through the last stretch, which OS sleeps are too coarse
+// to hit. How long that stretch must be is learnt from how late sleeps
+// actually wake up on this machine.
+class FrameLimiter {
+ public:
+  FrameLimiter();
+  ~FrameLimiter();
+
+  FrameLimiter(const FrameLimiter&) = delete;
+  void operator=(const FrameLimiter&) = delete;
+
+  void WaitUntil(std::chrono::steady_clock::time_point deadline);
+
+  // time spent asleep, i.e. CPU time saved over spinning, and time spun
+  uint64_t SleptNanoseconds() const { return slept_nanoseconds_; }
+  uint64_t SpunNanoseconds() const { return spun_nanoseconds_; }
+
+ private:
+  // running mean and variance of how long a 1 ms sleep really takes
+  double sleep_mean_ = 1e6;
+  double sleep_m2_ = 0;
+  uint64_t sleep_count_ = 1;
+
+  std::atomic<uint64_t> slept_nanoseconds_ = 0;
+  std::atomic<uint64_t> spun_nanoseconds_ = 0;
+};
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "aubengine/components/component.h"
 #include "aubengine/components/rigid_body_2d.h"
@@ -13,9 +15,12 @@ class Scene;
 class GameObject {
  public:
   GameObject(const std::string& name, Scene* scene);
+  virtual ~GameObject();
 
   void PhysicsUpdate();
   void Update();
+  void OnCollisionEnter(const Collision2D& collision);
+  void OnCollisionExit(const Collision2D& collision);
 
   template <Derived<Component> T, typename... Args>
   T* AddComponent(Args... args) {
@@ -43,6 +48,7 @@ class GameObject {
     std::shared_ptr<T> component = std::make_shared<T>(args...);
     component->SetOwner(this);
     components_.insert(component);
+    ordered_components_.emplace_back(next_component_key_++, component.get());
     component->Start();
     return component.get();
   }
@@ -58,6 +64,19 @@ class GameObject {
   }
   void RemoveComponent(Component* component);
   Scene* GetScene();
+  // unique within the scene, in the order objects were instantiated
+  uint64_t GetId() const { return id_; }
+  // State of the object and its components, for rollback. Each component's
+  // state is stored under the key it was added with, so components added or
+  // removed since a snapshot are skipped rather than handed another one's.
+  void SaveState(SnapshotWriter& writer) const;
+  void LoadState(SnapshotReader& reader);
+  // A static object stays where it is once placed. Its sprite is baked
+  // together with those of the other static objects around it, and drawn
+  // with them in one call per texture; the bake is redone only when static
+  // objects come or go, so moving one takes Scene::InvalidateStatic.
+  void SetStatic(bool isStatic);
+  bool IsStatic() const { return is_static_; }
 
  public:
   std::string name;
@@ -65,6 +84,22 @@ class GameObject {
   std::shared_ptr<RigidBody2D> rigid_body_2d = nullptr;
 
  private:
+  // keys of the body and the Transform, below those of other components
+  static constexpr uint32_t kRigidBodyKey = 0;
+  static constexpr uint32_t kTransformKey = 1;
+  static constexpr uint32_t kFirstComponentKey = 2;
+
   std::unordered_set<std::shared_ptr<Component>> components_;
+  // the components in the order they were added, by the key their state is
+  // saved under; the set's order changes with pointers and rehashing
+  std::vector<std::pair<uint32_t, Component*>> ordered_components_;
+  uint32_t next_component_key_ = kFirstComponentKey;
   Scene* scene_ = nullptr;
+  uint64_t id_ = 0;
+  bool is_static_ = false;
+  // chunk of static sprites the object was baked into, if placed
+  bool static_placed_ = false;
+  std::pair<int32_t, int32_t> static_chunk_{0, 0};
+
+  friend class Scene;
 };
\ No newline at end of file
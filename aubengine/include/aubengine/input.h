@@ -1,26 +1,141 @@
 #pragma once
 
 #include <bitset>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
 
+// One change of an input device, stamped with the steady clock when the
+// backend saw it.
+struct InputEvent {
+  enum class Type : int32_t {
+    kKey,
+    kChar,
+    kMouseButton,
+    kMouseMove,
+    kScroll,
+    kGamepadButton,
+    kGamepadAxis,
+  };
+
+  Type type = Type::kKey;
+  // key, button or axis, or the codepoint of a kChar
+  int32_t code = 0;
+  // 1 pressed, 0 released, 2 repeated, for keys and buttons
+  int32_t action = 0;
+  // gamepad of a gamepad event
+  int32_t device = 0;
+  // cursor position, scroll offset, or the axis value in x
+  float x = 0.0f;
+  float y = 0.0f;
+  uint64_t time_nanoseconds = 0;
+};
+
+// Input is fed by events the backend queues as they happen, from whichever
+// thread pumps window events. PollInput takes everything queued since the
+// last tick and applies it in order, so a key pressed and released between
+// two ticks still reads as pressed and released in the second one.
 class Input {
  public:
+  static constexpr int kMouseButtons = 8;
+  static constexpr int kMaxGamepads = 4;
+  static constexpr int kGamepadButtons = 15;
+  static constexpr int kGamepadAxes = 6;
+
   static void PollInput() { instance_->PollInputImpl(); }
+  // adds an event to those the next PollInput applies, from any thread
+  static void QueueEvent(const InputEvent& event) {
+    instance_->QueueEventImpl(event);
+  }
 
   static bool GetKeyDown(int key) { return instance_->GetKeyDownImpl(key); }
   static bool GetKey(int key) { return instance_->GetKeyImpl(key); }
   static bool GetKeyUp(int key) { return instance_->GetKeyUpImpl(key); }
 
+  static bool GetMouseButtonDown(int button) {
+    return instance_->mouse_pressed_[button];
+  }
+  static bool GetMouseButton(int button) {
+    return instance_->mouse_states_[button];
+  }
+  static bool GetMouseButtonUp(int button) {
+    return instance_->mouse_released_[button];
+  }
+  // in window coordinates, as of the last cursor event
+  static glm::vec2 GetMousePosition() { return instance_->mouse_position_; }
+  // scrolled during the current tick
+  static glm::vec2 GetScrollDelta() { return instance_->scroll_delta_; }
+
+  static bool GetGamepadButtonDown(int gamepad, int button) {
+    return instance_->gamepad_pressed_[gamepad * kGamepadButtons + button];
+  }
+  static bool GetGamepadButton(int gamepad, int button) {
+    return instance_->gamepad_states_[gamepad * kGamepadButtons + button];
+  }
+  static bool GetGamepadButtonUp(int gamepad, int button) {
+    return instance_->gamepad_released_[gamepad * kGamepadButtons + button];
+  }
+  static float GetGamepadAxis(int gamepad, int axis) {
+    return instance_->gamepad_axes_[gamepad][axis];
+  }
+
+  // the events the current tick applied, in order, text input included
+  static const std::vector<InputEvent>& GetEvents() {
+    return instance_->events_;
+  }
+
+  // Recording writes the events of every tick, from the next PollInput on,
+  // to a compact binary log (see InputLogWriter), starting with the keys and
+  // buttons already held. Replaying feeds a log back tick for tick in place
+  // of live input, so that a session plays out again exactly, headless
+  // included. Both are meant to be started before Run, or from the thread
+  // that ticks.
+  static bool StartRecording(const std::string& path);
+  static void StopRecording();
+  static bool StartReplay(const std::string& path);
+  static void StopReplay();
+  static bool IsReplaying();
+  // every tick of the log has been replayed
+  static bool IsReplayFinished();
+
  protected:
+  // Runs on whichever thread ticks, the simulation thread in threaded mode,
+  // so backends must not call into the windowing system here; device state
+  // is read where events are pumped, on the main thread, and queued.
   virtual void PollInputImpl() = 0;
+  void QueueEventImpl(const InputEvent& event);
+  // takes the queued events as the current tick's and applies them
+  void ApplyQueuedEvents();
+  // events that bring cleared state to the current one
+  std::vector<InputEvent> CurrentStateEvents() const;
+  void ResetState();
 
   virtual bool GetKeyDownImpl(int key) const = 0;
   virtual bool GetKeyImpl(int key) const = 0;
   virtual bool GetKeyUpImpl(int key) const = 0;
 
  protected:
+  // state at the end of the current tick, and what changed during it
   std::bitset<512> key_states_{};
-  std::bitset<512> old_key_states_{};
+  std::bitset<512> key_pressed_{};
+  std::bitset<512> key_released_{};
+  std::bitset<kMouseButtons> mouse_states_{};
+  std::bitset<kMouseButtons> mouse_pressed_{};
+  std::bitset<kMouseButtons> mouse_released_{};
+  glm::vec2 mouse_position_{};
+  glm::vec2 scroll_delta_{};
+  std::bitset<kMaxGamepads * kGamepadButtons> gamepad_states_{};
+  std::bitset<kMaxGamepads * kGamepadButtons> gamepad_pressed_{};
+  std::bitset<kMaxGamepads * kGamepadButtons> gamepad_released_{};
+  float gamepad_axes_[kMaxGamepads][kGamepadAxes]{};
+  std::vector<InputEvent> events_;
 
  private:
+  std::mutex queue_mutex_;
+  // swapped with events_ every tick, so neither allocates once warm
+  std::vector<InputEvent> queued_;
+
   static Input* instance_;
-};
\ No newline at end of file
+};
@@ -2,11 +2,20 @@
 
 #include "aubengine/input.h"
 
+struct GLFWwindow;
+
 class InputGLFW : public Input {
+ public:
+  // routes the window's key, text, mouse and scroll callbacks into the queue
+  static void Attach(GLFWwindow* window);
+  // GLFW has no gamepad callbacks, so the pads are compared with how they
+  // were at the last call, which must be on the thread pumping events
+  static void PollGamepads();
+
  protected:
   virtual bool GetKeyDownImpl(int key) const override;
   virtual bool GetKeyImpl(int key) const override;
   virtual bool GetKeyUpImpl(int key) const override;
 
   virtual void PollInputImpl() override;
-};
\ No newline at end of file
+};
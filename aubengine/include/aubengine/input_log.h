@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "aubengine/input.h"
+
+// Binary log of the input events of every tick. After a header, a record
+// per tick that had events: the ticks since the previous record and the
+// event count as varints, then each event, its fields packed and its time
+// as a varint delta from the previous one. A record without events marks
+// the tick recording stopped at. Ticks without input cost nothing, and a
+// held key costs nothing until it is released.
+class InputLogWriter {
+ public:
+  // false if the file cannot be created
+  bool Open(const std::string& path);
+  // appends the events of the next tick
+  void WriteTick(const std::vector<InputEvent>& events);
+  void Close();
+
+ private:
+  void Flush();
+
+  std::ofstream file_;
+  std::vector<uint8_t> buffer_;
+  uint64_t tick_ = 0;
+  uint64_t last_record_tick_ = 0;
+  uint64_t last_time_ = 0;
+};
+
+class InputLogReader {
+ public:
+  // false if the file cannot be read or is not an input log
+  bool Open(const std::string& path);
+  // appends the events of the next tick, with times shifted so the log
+  // starts now
+  void ReadTick(std::vector<InputEvent>& events);
+  // every tick of the log has been read
+  bool IsFinished() const { return finished_; }
+
+ private:
+  bool ReadRecordHeader();
+
+  std::vector<uint8_t> data_;
+  size_t offset_ = 0;
+  uint64_t tick_ = 0;
+  uint64_t next_record_tick_ = 0;
+  uint64_t next_record_events_ = 0;
+  uint64_t last_time_ = 0;
+  bool finished_ = false;
+};
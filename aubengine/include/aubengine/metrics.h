@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Distribution of the samples in a histogram's window.
+struct HistogramSummary {
+  uint64_t count = 0;
+  double mean = 0;
+  double min = 0;
+  double max = 0;
+  double p50 = 0;
+  double p99 = 0;
+};
+
+// Counts events, per frame and in total.
+class MetricCounter {
+ public:
+  void Add(uint64_t amount = 1) {
+    frame_.fetch_add(amount, std::memory_order_relaxed);
+  }
+  // count of the last finished frame
+  uint64_t LastFrame() const { return last_frame_; }
+  uint64_t Total() const { return total_ + frame_; }
+
+ private:
+  friend class Metrics;
+
+  std::atomic<uint64_t> frame_ = 0;
+  std::atomic<uint64_t> last_frame_ = 0;
+  std::atomic<uint64_t> total_ = 0;
+};
+
+// Holds the latest value of a quantity.
+class MetricGauge {
+ public:
+  void Set(double value) { value_.store(value, std::memory_order_relaxed); }
+  double Get() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<double> value_ = 0;
+};
+
+// Keeps the latest kWindow samples, so percentiles follow recent behaviour
+// rather than the whole run.
+class MetricHistogram {
+ public:
+  static constexpr size_t kWindow = 1024;
+
+  void Observe(double value);
+  HistogramSummary Summarize() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<double> samples_;
+  size_t next_ = 0;
+};
+
+// A static registry of named metrics that engine systems publish into.
+// Looking a metric up takes a lock, so call sites look theirs up once and
+// keep the reference, which stays valid for the lifetime of the program;
+// updating it is then lock-free, except for histograms.
+class Metrics {
+ public:
+  static MetricCounter& GetCounter(const std::string& name);
+  static MetricGauge& GetGauge(const std::string& name);
+  static MetricHistogram& GetHistogram(const std::string& name);
+  // closes the current frame of every counter
+  static void EndFrame();
+  // writes one row per metric, sorted by name, for regression tracking
+  static bool DumpCsv(const std::string& path);
+
+ private:
+  Metrics() {}
+};
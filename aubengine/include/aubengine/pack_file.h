@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+// On-disk layout of an asset pack, as written by the packer tool and read by
+// VirtualFileSystem:
+//
+//   PackHeader
+//   PackEntry[entry_count]   sorted by path, for binary search
+//   path strings             not null-terminated, referenced by the entries
+//   entry data               concatenated, each entry stored or LZ4 block
+//
+// All offsets are from the start of the file and all fields little-endian.
+constexpr uint32_t kPackMagic = 0x50425541;  // "AUBP"
+constexpr uint32_t kPackVersion = 1;
+
+enum PackEntryFlags : uint32_t {
+  kPackEntryLZ4 = 1 << 0,
+};
+
+struct PackHeader {
+  uint32_t magic = kPackMagic;
+  uint32_t version = kPackVersion;
+  uint32_t entry_count = 0;
+  uint32_t reserved = 0;
+};
+
+struct PackEntry {
+  uint64_t path_offset = 0;
+  uint64_t data_offset = 0;
+  // bytes in the pack, and bytes once decompressed
+  uint64_t stored_size = 0;
+  uint64_t size = 0;
+  uint32_t path_length = 0;
+  uint32_t flags = 0;
+};
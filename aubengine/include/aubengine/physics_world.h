@@ -0,0 +1,220 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "box2d/box2d.h"
+
+class RigidBody2D;
+
+// A change game code makes to a body, applied by PhysicsWorld right before
+// the next step.
+struct PhysicsCommand {
+  enum class Type {
+    kSetTransform,
+    kSetLinearVelocity,
+    kApplyForce,
+    kApplyLinearImpulse,
+    kSetAwake,
+  };
+
+  Type type = Type::kSetTransform;
+  b2Body* body = nullptr;
+  b2Vec2 vector{0.0f, 0.0f};
+  float angle = 0.0f;
+  bool flag = false;
+};
+
+// Pose of a body as of the last completed step.
+struct PhysicsBodyState {
+  b2Vec2 position{0.0f, 0.0f};
+  float angle = 0.0f;
+  // step the pose last changed in, so readers can skip bodies at rest
+  uint64_t revision = 0;
+};
+
+// Two bodies starting or ceasing to touch during a step. A contact involving
+// a sensor fixture is a trigger: the bodies overlap without colliding.
+struct PhysicsContact {
+  b2Body* body_a = nullptr;
+  b2Body* body_b = nullptr;
+  bool begin = false;
+  bool is_trigger = false;
+};
+
+// Everything about a body a rollback restores, without padding so that
+// snapshots of the same state are the same bytes.
+struct PhysicsBodySnapshot {
+  b2Vec2 position{0.0f, 0.0f};
+  float angle = 0.0f;
+  b2Vec2 linear_velocity{0.0f, 0.0f};
+  float angular_velocity = 0.0f;
+  uint32_t awake = 0;
+};
+
+// Owns a b2World and steps it on a worker thread of its own, so the step of
+// a tick overlaps the rendering of the frame and the input polling of the
+// next tick.
+//
+// A tick goes: EndStep waits for the step in flight and publishes its
+// poses; game code reads them through GetState and queues its changes with
+// Enqueue; BeginStep hands the queue and the next step to the worker. The
+// worker only reports the bodies that were awake, which EndStep merges into
+// the poses readers see, so bodies at rest cost next to nothing.
+//
+// Contacts are recorded by the world's contact listener into a buffer that is
+// reused from step to step, so the solver callbacks do not allocate once the
+// buffer has grown to the busiest step seen, and are handed out as one batch
+// per step by EndStep.
+//
+// New bodies join the broadphase at the start of the next step, after the
+// queued commands have moved them, so spawning many objects and placing them
+// creates each proxy once, where it belongs, rather than creating and then
+// moving it. Until then they are in the world but nothing collides with them.
+class PhysicsWorld : private b2ContactListener {
+ public:
+  // steps a single tick may run at a fixed step rate; time beyond is dropped
+  static constexpr uint32_t kMaxSubsteps = 8;
+  // contacts a step may record before its buffer grows
+  static constexpr size_t kContactCapacity = 1024;
+  // steps per second of a deterministic world without a step rate of its own
+  static constexpr uint32_t kDeterministicStepRate = 60;
+  // grid deterministic worlds snap poses and velocities to, per unit
+  static constexpr float kDeterministicScale = 4096.0f;
+
+  PhysicsWorld(const b2Vec2& gravity);
+  ~PhysicsWorld();
+
+  // Creating and destroying bodies and fixtures mutates the world directly,
+  // so these end the step in flight, if any, first. Like EndStep, they are
+  // meant for the thread that runs the ticks.
+  // Destroying a body ends its contacts without reporting them, and drops
+  // those recorded but not dispatched yet.
+  b2Body* CreateBody(const b2BodyDef& bodyDef, RigidBody2D* owner = nullptr);
+  void DestroyBody(b2Body* body);
+  b2Fixture* CreateFixture(b2Body* body, const b2FixtureDef& fixtureDef);
+  void DestroyFixture(b2Body* body, b2Fixture* fixture);
+  // Bulk versions, for distinct bodies, which end the step in flight and
+  // take the locks once, and purge queued commands and contacts in one pass.
+  std::vector<b2Body*> CreateBodies(std::span<const b2BodyDef> bodyDefs);
+  void DestroyBodies(std::span<b2Body* const> bodies);
+  // makes room for that many bodies, ahead of a mass spawn
+  void Reserve(size_t bodies);
+  // A disabled body keeps its fixtures but leaves the broadphase, which ends
+  // its contacts, so pooled objects can park their bodies and reuse them
+  // instead of destroying and recreating them. Enabling takes effect at the
+  // next step, like creation.
+  void SetEnabled(b2Body* body, bool enabled);
+  void SetGravity(const b2Vec2& gravity);
+  // Steps the world at hz steps per second of simulated time, however often
+  // ticks come, 0 (the default) meaning one step per tick.
+  void SetStepRate(uint32_t hz);
+  void SetIterations(int32_t velocityIterations, int32_t positionIterations);
+  // A deterministic world gives the same results on every machine fed the
+  // same ticks, for lockstep and replays: every tick runs exactly one step of
+  // 1 / step rate, whatever the tick rate; commands are applied in body
+  // order rather than in the order game code happened to queue them; and
+  // after each step the state of moving bodies is snapped to a fixed-point
+  // grid, so that rounding differences cannot compound. The scene owning
+  // the world also runs its objects in id order. Box2D itself must be built
+  // without contraction or fast math, see AUBENGINE_STRICT_FLOAT.
+  void SetDeterministic(bool deterministic);
+  bool IsDeterministic() const { return deterministic_; }
+
+  void Enqueue(const PhysicsCommand& command);
+  void Enqueue(const std::vector<PhysicsCommand>& commands);
+
+  // Starts stepping through elapsed seconds on the worker thread, after
+  // applying the queued commands: a single step, or at a fixed step rate as
+  // many whole steps as elapsed time has accumulated, up to kMaxSubsteps.
+  void BeginStep(float elapsed);
+  // waits for the step in flight and publishes the poses it computed
+  void EndStep();
+
+  // pose of the body as of the last step published by EndStep
+  const PhysicsBodyState& GetState(b2Body* body) const;
+  uint32_t GetAwakeBodyCount() const { return awake_bodies_; }
+  // Hash of the poses published by EndStep, in fixed point, for clients and
+  // servers to compare every tick; a pass over the bodies, without locking.
+  uint64_t Checksum() const;
+  // Rollback. Restoring sets the body's state and publishes its pose right
+  // away, returning the revision it is published with. Box2D's contact
+  // cache is not part of it, so the steps re-simulated after a restore warm
+  // start from the contacts as they are rather than as they were.
+  PhysicsBodySnapshot SaveBody(b2Body* body);
+  uint64_t RestoreBody(b2Body* body, const PhysicsBodySnapshot& snapshot);
+  // drops queued commands and undispatched contacts, which belong to the
+  // ticks a rollback undoes
+  void DiscardPending();
+  // component the body belongs to, if any
+  RigidBody2D* GetOwner(b2Body* body) const;
+  void SetOwner(b2Body* body, RigidBody2D* owner);
+  // contacts of the last step published by EndStep, in the order they began
+  // and ended; a destroyed body leaves nullptr in those it was part of
+  const std::vector<PhysicsContact>& GetContacts() const { return contacts_; }
+
+  PhysicsWorld(const PhysicsWorld&) = delete;
+  void operator=(const PhysicsWorld&) = delete;
+
+ private:
+  void Run();
+  void ApplyCommands(std::vector<PhysicsCommand>& commands);
+  // snaps the state of moving bodies to the deterministic grid
+  void Quantize();
+  // called by Box2D from within the step, on the worker
+  void BeginContact(b2Contact* contact) override;
+  void EndContact(b2Contact* contact) override;
+  void RecordContact(b2Contact* contact, bool begin);
+  b2Body* CreateBodyLocked(const b2BodyDef& bodyDef, RigidBody2D* owner);
+
+  // guards the world itself, held by the worker throughout a step
+  std::mutex world_mutex_;
+  b2World world_;
+  // bodies by index, which each body keeps in its user data
+  std::vector<b2Body*> bodies_;
+  std::vector<RigidBody2D*> owners_;
+  // whether each body was awake after the previous step, written by the
+  // worker: a body that falls asleep still moved during that last step
+  std::vector<uint8_t> was_awake_;
+  // poses readers see, written by the thread that runs the ticks only
+  std::vector<PhysicsBodyState> states_;
+  // poses of the bodies the step in flight moves, by index
+  std::vector<std::pair<uint32_t, PhysicsBodyState>> changes_;
+  // bodies to add to the broadphase once the next step's commands are applied
+  std::vector<b2Body*> pending_enable_;
+  // recorded by the step in flight, then swapped with contacts_ by EndStep
+  std::vector<PhysicsContact> recorded_;
+  std::vector<PhysicsContact> contacts_;
+  uint64_t steps_ = 0;
+  // written by the worker, read from the tick and by metrics
+  std::atomic<uint32_t> awake_bodies_ = 0;
+
+  std::mutex commands_mutex_;
+  std::vector<PhysicsCommand> commands_;
+  // the worker's copy, swapped with commands_ so the queue stays open
+  std::vector<PhysicsCommand> applying_;
+
+  // hand-off between the game thread and the worker
+  std::mutex step_mutex_;
+  std::condition_variable step_condition_;
+  bool step_requested_ = false;
+  bool step_in_flight_ = false;
+  bool stopping_ = false;
+  float time_step_ = 0.0f;
+  uint32_t substeps_ = 0;
+  int32_t velocity_iterations_ = 6;
+  int32_t position_iterations_ = 2;
+  uint32_t step_rate_ = 0;
+  bool deterministic_ = false;
+  // simulated time not stepped yet, at a fixed step rate
+  float accumulator_ = 0.0f;
+  // started by the first BeginStep, so programs without physics have no
+  // idle thread
+  std::thread worker_;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// One timed zone. Names are not copied, so they must outlive the profiler:
+// string literals, in practice.
+struct ProfileEvent {
+  const char* name = nullptr;
+  uint64_t start_nanoseconds = 0;
+  uint64_t end_nanoseconds = 0;
+};
+
+// A static frame profiler. Zones are recorded into a ring buffer per thread,
+// written only by its thread, so recording takes no lock; the buffers keep
+// the latest kEventsPerThread zones of each thread. Disabled, a zone costs a
+// single relaxed load.
+class Profiler {
+ public:
+  static constexpr size_t kEventsPerThread = 1 << 16;
+
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+  // nanoseconds on the clock every zone is measured with
+  static uint64_t Now();
+  // records a zone on the calling thread's timeline
+  static void Record(const char* name, uint64_t start, uint64_t end);
+  // records a zone measured on the GPU, on a timeline of its own
+  static void RecordGpu(const char* name, uint64_t start, uint64_t end);
+  // writes every buffered zone in the Chrome trace event format, to be
+  // opened in chrome://tracing or Perfetto. Meant for when recording is
+  // paused or done: zones overwritten during the export may come out torn.
+  static bool ExportChromeTrace(const std::string& path);
+
+ private:
+  Profiler() {}
+
+  static std::atomic<bool> enabled_;
+};
+
+// Times the enclosing scope.
+class ProfileScope {
+ public:
+  explicit ProfileScope(const char* name)
+      : name_(Profiler::IsEnabled() ? name : nullptr),
+        start_(name_ ? Profiler::Now() : 0) {}
+  ~ProfileScope() {
+    if (name_) {
+      Profiler::Record(name_, start_, Profiler::Now());
+    }
+  }
+
+  ProfileScope(const ProfileScope&) = delete;
+  void operator=(const ProfileScope&) = delete;
+
+ private:
+  const char* name_;
+  uint64_t start_;
+};
+
+#define AUBENGINE_PROFILE_CONCAT_INNER(a, b) a##b
+#define AUBENGINE_PROFILE_CONCAT(a, b) AUBENGINE_PROFILE_CONCAT_INNER(a, b)
+#define AUBENGINE_PROFILE_SCOPE(name) \
+  ProfileScope AUBENGINE_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+
+// Measures GPU time of the passes of one context with timestamp queries.
+// Results are read back frames later, once available, so measuring never
+// stalls the pipeline.
+class GpuTimer {
+ public:
+  void Initialize(GladGLContext* context);
+  void Release();
+  void Begin(const char* name);
+  void End();
+  // records the passes whose results have arrived into the Profiler
+  void Collect();
+
+ private:
+  struct Pass {
+    const char* name = nullptr;
+    unsigned int begin = 0;
+    unsigned int end = 0;
+  };
+
+  unsigned int AcquireQuery();
+
+  GladGLContext* context_ = nullptr;
+  std::vector<unsigned int> free_queries_;
+  std::deque<Pass> pending_;
+  Pass current_;
+  // GPU timestamp minus Profiler::Now, measured once at Initialize
+  int64_t gpu_offset_ = 0;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <memory>
+
+class Texture2D;
+
+// An offscreen framebuffer drawn into instead of the window, whose color
+// buffer is a texture that can then be drawn like any other, e.g. to cache
+// what rarely changes and composite it as a single quad.
+//
+// The framebuffer belongs to the context it was created with, and is only
+// used where that context is current; the texture, like all textures, is
+// shared by every window's context.
+class RenderTarget {
+ public:
+  RenderTarget(GladGLContext* context, uint32_t width, uint32_t height);
+  ~RenderTarget();
+
+  // Redirects drawing to the target, cleared to transparent, until End,
+  // which restores the framebuffer and viewport that were in use before.
+  void Begin();
+  void End();
+  // recreates the target at the new size, dropping what it held
+  void Resize(uint32_t width, uint32_t height);
+
+  // premultiplied by alpha when drawn into with premultiplied blending
+  std::shared_ptr<Texture2D> GetTexture() const { return texture_; }
+  uint32_t GetWidth() const { return width_; }
+  uint32_t GetHeight() const { return height_; }
+  // false if the driver refused the framebuffer, in which case Begin draws
+  // to wherever drawing went before
+  bool IsComplete() const { return complete_; }
+
+  RenderTarget(const RenderTarget&) = delete;
+  void operator=(const RenderTarget&) = delete;
+
+ private:
+  void Create();
+  void Destroy();
+
+  GladGLContext* context_ = nullptr;
+  unsigned int framebuffer_ = 0;
+  std::shared_ptr<Texture2D> texture_;
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+  bool complete_ = false;
+  // what Begin replaced, for End to put back
+  int previous_framebuffer_ = 0;
+  int previous_viewport_[4] = {0, 0, 0, 0};
+};
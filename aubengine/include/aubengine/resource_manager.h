@@ -7,11 +7,27 @@
 #include "aubengine/shader.h"
 #include "aubengine/texture_2d.h"
 
+// GPU memory use of the textures held by ResourceManager, as of the last
+// frame boundary
+struct TextureResidencyStats {
+  uint64_t budget_bytes = 0;
+  uint64_t resident_bytes = 0;
+  uint32_t resident_textures = 0;
+  uint32_t evicted_textures = 0;
+  uint32_t pending_stream_ins = 0;
+  // totals since startup
+  uint64_t evictions = 0;
+  uint64_t stream_ins = 0;
+};
+
 // A static singleton ResourceManager class that hosts several
 // functions to load Textures and Shaders. Each loaded texture
 // and/or shader is also stored for future reference by string
 // handles. All functions and resources are static and no
 // public constructor is defined.
+// All OpenGL windows live in one context share group, so a single registry
+// serves every window: loading a name that is already stored returns the
+// stored resource, and Clear must be called once, not once per window.
 class ResourceManager {
  public:
   // resource storage
@@ -32,8 +48,21 @@ class ResourceManager {
                                                 GladGLContext* context);
   // retrieves a stored texture
   static std::shared_ptr<Texture2D> GetTexture(std::string name);
-  // properly de-allocates all loaded resources
+  // properly de-allocates all loaded resources; context may be any context of
+  // the share group, as long as it is current
   static void Clear(GladGLContext* context);
+  // watches the files of every loaded shader and texture and, when one
+  // changes, reloads the resource in place behind its existing handle
+  static void EnableHotReload(bool enabled);
+  // applies finished reloads and stream-ins and evicts textures over budget;
+  // called by Application at every frame boundary, with a context of the
+  // share group current
+  static void Update();
+  // caps the GPU memory textures may take, 0 (the default) meaning no cap.
+  // Over budget, the least recently bound textures are evicted, and a bind of
+  // an evicted texture streams it back in asynchronously.
+  static void SetTextureBudget(uint64_t bytes);
+  static TextureResidencyStats GetTextureResidencyStats();
 
  private:
   // private constructor, that is we do not want any actual resource manager
@@ -1,36 +1,169 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <unordered_set>
+#include <vector>
 
 #include "aubengine/game_object.h"
+#include "aubengine/physics_world.h"
+#include "aubengine/render_target.h"
+#include "aubengine/snapshot.h"
+#include "aubengine/sprite_renderer.h"
 #include "aubengine/utils/derived.h"
 
 class Window;
 class Prefab;
-class SpriteRenderer;
 
 class Scene {
  public:
   Scene(Window* window, SpriteRenderer* renderer);
-  virtual ~Scene() = default;
+  virtual ~Scene();
 
   void PhysicsUpdate();
   void Update();
-  void Render();
+  // draws the scene alpha of the way from the previous tick to the current
+  void Render(float alpha = 1.0f);
+  // Captures the render state of every sprite, at the end of a tick. Once a
+  // capture has been published, Render draws the latest one instead of the
+  // live objects, so it can run on another thread than the simulation.
+  void PublishRenderState();
+
+  // A cached layer is drawn into a render target of its own only when it is
+  // invalidated, when sprites join or leave it, or after a rollback, and the
+  // target is drawn as a single quad every frame in between, which suits
+  // backgrounds and other sprites that rarely change. Sprites join a layer
+  // through their layer_. Layers are drawn in the order they were created,
+  // behind the sprites of no layer. They are created before Run, while
+  // invalidating is fine from the simulation.
+  int32_t CreateCachedLayer();
+  // redraws the layer next frame, e.g. after moving or recoloring a sprite
+  void InvalidateLayer(int32_t layer);
+  // Takes the static object out of the chunk it was baked into, and bakes
+  // it again where it is now, with its sprite as it is now; for when it
+  // moved or its sprite changed. SetStatic and new sprites call it.
+  void InvalidateStatic(GameObject* gameObject);
+  // Frees the GPU objects of the layers and static batches, which must go
+  // while the window's context is current; the next Render creates them
+  // again.
+  void ReleaseRenderResources();
 
   template <Derived<GameObject> T>
   T* Instantiate() {
     std::shared_ptr<T> go = std::make_shared<T>(this);
+    go->id_ = ++next_object_id_;
     game_objects_.insert(go);
+    ordered_objects_dirty_ = true;
     return go.get();
   }
   void Destroy(GameObject* gameObject);
+  // destroys the objects and their bodies in one go
+  void Destroy(std::span<GameObject* const> gameObjects);
   Window* GetWindow();
+  // Every scene simulates its bodies in a world of its own, with its own
+  // gravity and step rate, stepped on a thread of its own.
+  PhysicsWorld& GetPhysicsWorld();
+
+  // Rollback. A snapshot holds the state of every object, its Transform,
+  // body and components, in one flat buffer, taken at the start of a tick.
+  // Loading it puts the objects that still exist back in place, so that the
+  // next PhysicsUpdate runs that tick again; objects created since are
+  // destroyed, and ids are handed out again from where they were, so the
+  // ticks run again spawn the same objects under the same ids. Objects
+  // destroyed since are not brought back.
+  void SaveSnapshot(std::vector<std::byte>& snapshot);
+  void LoadSnapshot(std::span<const std::byte> snapshot);
+  // With a history, a snapshot of each of the last ticks is kept, delta
+  // compressed, which Rollback goes back to; 0 (the default) keeps none.
+  void SetSnapshotHistory(uint32_t ticks);
+  // false if the tick is no longer held
+  bool Rollback(uint64_t tick);
+  // ticks run so far, the current one included
+  uint64_t GetTick() const { return tick_; }
 
  private:
+  // the objects by id, which is the order snapshots list them in
+  const std::vector<GameObject*>& OrderedObjects();
+  // calls f on every object, in id order when the world is deterministic
+  template <typename F>
+  void ForEachObject(F&& f);
+
+  // hands the contacts of the last step to both objects of each
+  void DispatchContacts();
+  void DispatchContact(b2Body* self, b2Body* other,
+                       const PhysicsContact& contact);
+  // redraws the layers that need it, then composites all of them
+  void RenderLayers(std::span<const SpriteRenderState> sprites);
+  // places pending static objects and rebakes the chunks that changed, on
+  // the thread that owns the objects
+  void BakeStatic();
+  void DrawStatic();
+  // takes the object out of its chunk, if it was placed in one
+  void RemoveStatic(GameObject* gameObject);
+
   Window* window_ = nullptr;
   SpriteRenderer* renderer_ = nullptr;
+  // declared before the objects, so it outlives their bodies
+  PhysicsWorld physics_world_;
 
   std::unordered_set<std::shared_ptr<GameObject>> game_objects_;
+  uint64_t next_object_id_ = 0;
+  std::vector<GameObject*> ordered_objects_;
+  bool ordered_objects_dirty_ = false;
+  // the copy of ordered_objects_ a deterministic tick walks
+  std::vector<GameObject*> tick_order_;
+  uint64_t tick_ = 0;
+  SnapshotHistory snapshot_history_;
+  std::vector<std::byte> snapshot_buffer_;
+  // reused every tick to hand the transforms to the physics world at once
+  std::vector<PhysicsCommand> physics_commands_;
+
+  struct RenderSnapshot {
+    std::vector<SpriteRenderState> sprites;
+    std::chrono::steady_clock::time_point time;
+  };
+  // The simulation fills back_ and swaps it with ready_; Render swaps ready_
+  // with front_ when a newer capture is there and draws front_. Neither side
+  // waits for the other beyond the swaps.
+  RenderSnapshot snapshot_back_;
+  RenderSnapshot snapshot_ready_;
+  RenderSnapshot snapshot_front_;
+  bool snapshot_fresh_ = false;
+  bool snapshots_published_ = false;
+  std::mutex snapshot_mutex_;
+  // the live objects' sprites, captured by Render when nothing is published
+  std::vector<SpriteRenderState> live_sprites_;
+
+  struct CachedLayer {
+    // created by the first Render, where the window's context is current
+    std::unique_ptr<RenderTarget> target;
+    // the layer is composited with the shader its sprites are drawn with
+    std::shared_ptr<Shader> shader;
+    // hash of the objects in the layer as of the last redraw, and this frame
+    uint64_t drawn_members = 0;
+    uint64_t members = 0;
+    std::atomic<bool> dirty = true;
+  };
+  std::vector<std::unique_ptr<CachedLayer>> layers_;
+
+  // Static sprites are baked per chunk of the world this many units square,
+  // so that adding or removing one rebakes its neighbours only, and chunks
+  // out of view are culled as a whole.
+  static constexpr float kStaticChunkSize = 512.0f;
+  struct StaticChunk {
+    std::vector<GameObject*> objects;
+    // one per shader, texture and color in the chunk
+    std::vector<SpriteBatch> batches;
+    bool dirty = false;
+  };
+  // guards the chunks' batches, baked by the simulation and drawn by Render
+  std::mutex static_mutex_;
+  std::map<std::pair<int32_t, int32_t>, StaticChunk> static_chunks_;
+  // static objects to place at the next bake
+  std::vector<GameObject*> static_pending_;
+  bool static_dirty_ = false;
 };
\ No newline at end of file
@@ -4,12 +4,25 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 // General purpsoe shader object. Compiles from file, generates
 // compile/link-time error messages and hosts several utility
 // functions for easy management.
 class Shader {
+ public:
+  // shader objects and program of a compilation whose result has not been
+  // queried yet
+  struct PendingProgram {
+    unsigned int vertex = 0;
+    unsigned int fragment = 0;
+    unsigned int program = 0;
+    std::string vertex_source;
+    std::string fragment_source;
+  };
+
  public:
   // state
   uint32_t id = 0;
@@ -21,6 +34,20 @@ class Shader {
   void Compile(
       const char* vertexSource,
       const char* fragmentSource);  // note: geometry source code is optional
+  // issues the compilation of a replacement program without waiting for the
+  // driver to finish it
+  PendingProgram BeginCompile(const char* vertexSource,
+                              const char* fragmentSource);
+  // checks a compilation started by BeginCompile; on success the new program
+  // replaces the current one, on failure the current one is kept
+  bool EndCompile(const PendingProgram& pending);
+  // The program to draw with from the given context. Uniforms live in the
+  // program, so contexts drawing at once from threads of their own would
+  // overwrite each other's: every context but the one the shader was
+  // compiled with links a copy of its own, relinked after a reload.
+  unsigned int GetProgram(GladGLContext* context);
+  // deletes the program and every copy of it
+  void Release(GladGLContext* context);
   // utility functions
   void SetFloat(const char* name, float value, bool useShader = false);
   void SetInteger(const char* name, int value, bool useShader = false);
@@ -39,7 +66,22 @@ class Shader {
                   bool useShader = false);
 
  private:
+  struct ContextProgram {
+    unsigned int program = 0;
+    uint64_t revision = 0;
+  };
+
+  // compiles and links the sources into a program of the given context
+  unsigned int Link(GladGLContext* context, const char* vertexSource,
+                    const char* fragmentSource);
   // checks if compilation or linking failed and if so, print the error logs
-  void CheckCompileErrors(unsigned int object, std::string type);
+  bool CheckCompileErrors(GladGLContext* context, unsigned int object,
+                          std::string type);
   GladGLContext* context_ = nullptr;
+  // sources of the current program, to link the copies of other contexts
+  std::string vertex_source_;
+  std::string fragment_source_;
+  uint64_t revision_ = 0;
+  std::mutex programs_mutex_;
+  std::unordered_map<GladGLContext*, ContextProgram> programs_;
 };
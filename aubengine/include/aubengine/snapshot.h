@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Appends plain values to a snapshot buffer, byte for byte, so saving state
+// is a series of memcpys and two snapshots of the same objects line up for
+// delta compression.
+class SnapshotWriter {
+ public:
+  explicit SnapshotWriter(std::vector<std::byte>& buffer) : buffer_(buffer) {}
+
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    size_t offset = buffer_.size();
+    buffer_.resize(offset + sizeof(T));
+    std::memcpy(buffer_.data() + offset, &value, sizeof(T));
+  }
+  // overwrites a value written earlier, for sizes known only afterwards
+  template <typename T>
+  void WriteAt(size_t offset, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::memcpy(buffer_.data() + offset, &value, sizeof(T));
+  }
+  size_t Size() const { return buffer_.size(); }
+
+ private:
+  std::vector<std::byte>& buffer_;
+};
+
+// Reads values back in the order they were written.
+class SnapshotReader {
+ public:
+  explicit SnapshotReader(std::span<const std::byte> buffer)
+      : buffer_(buffer) {}
+
+  // false, leaving value untouched, past the end of the buffer
+  template <typename T>
+  bool Read(T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (offset_ + sizeof(T) > buffer_.size()) {
+      offset_ = buffer_.size();
+      return false;
+    }
+    std::memcpy(&value, buffer_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+  void Skip(size_t bytes) {
+    offset_ = std::min(offset_ + bytes, buffer_.size());
+  }
+  // a reader of the next bytes alone, which are skipped here
+  SnapshotReader Take(size_t bytes) {
+    size_t size = std::min(bytes, buffer_.size() - offset_);
+    SnapshotReader reader(buffer_.subspan(offset_, size));
+    offset_ += size;
+    return reader;
+  }
+  size_t Offset() const { return offset_; }
+  bool AtEnd() const { return offset_ == buffer_.size(); }
+
+ private:
+  std::span<const std::byte> buffer_;
+  size_t offset_ = 0;
+};
+
+// Snapshots of the last ticks, for rollback. Only the newest is kept whole;
+// each older one is stored as the bytes that differ from the one after it,
+// XORed and run-length encoded, which for consecutive ticks of a scene
+// mostly at rest is a small fraction of the whole. Going back n ticks
+// decodes n deltas.
+class SnapshotHistory {
+ public:
+  explicit SnapshotHistory(uint32_t capacity = 0);
+
+  // Adds the snapshot of tick, which must follow the newest one or replace
+  // it; the oldest is dropped once capacity ticks are held.
+  void Push(uint64_t tick, std::span<const std::byte> snapshot);
+  // false if the tick is not held
+  bool Get(uint64_t tick, std::vector<std::byte>& snapshot) const;
+  // Forgets the ticks after tick, which becomes the newest, with the given
+  // snapshot, as after restoring it.
+  void Rewind(uint64_t tick, std::span<const std::byte> snapshot);
+  void Clear();
+
+  uint32_t GetCapacity() const { return capacity_; }
+  size_t GetStoredBytes() const;
+
+ private:
+  struct Entry {
+    uint64_t tick = 0;
+    // whether data encodes the difference to the next newer snapshot,
+    // rather than being the snapshot, when their sizes differ
+    bool is_delta = false;
+    std::vector<std::byte> data;
+  };
+
+  static void EncodeDelta(std::span<const std::byte> from,
+                          std::span<const std::byte> to,
+                          std::vector<std::byte>& delta);
+  static void ApplyDelta(std::span<const std::byte> delta,
+                         std::vector<std::byte>& snapshot);
+
+  uint32_t capacity_ = 0;
+  // older snapshots, a ring ordered oldest to newest from head_
+  std::vector<Entry> entries_;
+  size_t head_ = 0;
+  size_t count_ = 0;
+  std::vector<std::byte> newest_;
+  uint64_t newest_tick_ = 0;
+  bool has_newest_ = false;
+};
@@ -1,9 +1,89 @@
 #pragma once
 
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "aubengine/game_object.h"
 
+class Shader;
+class Texture2D;
+
+// Everything needed to draw one sprite, captured from its GameObject so that
+// it can be drawn while the simulation carries on with the next tick.
+struct SpriteRenderState {
+  std::shared_ptr<Shader> shader = nullptr;
+  std::shared_ptr<Texture2D> texture = nullptr;
+  glm::vec3 color{1, 1, 1};
+  GladGLContext* context = nullptr;
+  glm::vec3 previous_position{};
+  glm::vec3 position{};
+  glm::vec3 size{};
+  glm::vec3 previous_euler_rotation{};
+  glm::vec3 euler_rotation{};
+  // cached layer of the scene the sprite is drawn into, -1 for none
+  int32_t layer = -1;
+  // id of the object the sprite was captured from
+  uint64_t object_id = 0;
+};
+
+// Sprites that share a shader, texture and color, baked in world space into
+// one vertex buffer, so that however many there are they draw in one call.
+struct SpriteBatch {
+  std::shared_ptr<Shader> shader = nullptr;
+  std::shared_ptr<Texture2D> texture = nullptr;
+  glm::vec3 color{1, 1, 1};
+  GladGLContext* context = nullptr;
+  // position and texture coordinates of every corner, and two triangles per
+  // sprite
+  std::vector<float> vertices;
+  std::vector<uint32_t> indices;
+  // bounds of the sprites, to cull the batch as a whole
+  glm::vec2 min{0, 0};
+  glm::vec2 max{0, 0};
+  // bumped by every change, so DrawBatch uploads the buffers again
+  uint64_t revision = 0;
+
+  // GPU copy, owned by the context
+  unsigned int vao = 0;
+  unsigned int vbo = 0;
+  unsigned int ebo = 0;
+  uint64_t uploaded_revision = 0;
+};
+
 class SpriteRenderer {
  public:
-  // Renders a defined quad textured with given sprite
-  void DrawSprite(GameObject* go);
-};
\ No newline at end of file
+  // extent of the fixed orthographic projection every sprite is drawn with
+  static constexpr float kViewWidth = 800.0f;
+  static constexpr float kViewHeight = 600.0f;
+
+  // Renders a defined quad textured with given sprite, at its transform
+  // interpolated alpha of the way from the previous tick to the current one
+  void DrawSprite(GameObject* go, float alpha = 1.0f);
+  void DrawSprite(const SpriteRenderState& state, float alpha);
+  // Captures the sprite of go, false if go has none. Capturing needs no
+  // context, so headless runs capture what a renderer would draw, while
+  // drawing skips sprites without a context.
+  static bool CaptureSprite(GameObject* go, SpriteRenderState& state);
+  // Appends the sprite to the batch, as it is drawn at the current tick; the
+  // batch must share its shader, texture and color.
+  static void BakeSprite(const SpriteRenderState& state, SpriteBatch& batch);
+  // uploads the batch if it changed since it was last drawn, and draws it
+  void DrawBatch(SpriteBatch& batch);
+  // frees the batch's buffers, where its context is current
+  static void ReleaseBatch(SpriteBatch& batch);
+
+ private:
+  // returns the unit quad every sprite is drawn with, creating it on first
+  // use; vertex arrays are not shared between contexts, hence one each
+  unsigned int GetQuad(GladGLContext* context);
+
+  // windows that render on threads of their own may share a renderer
+  std::mutex quads_mutex_;
+  std::unordered_map<GladGLContext*, unsigned int> quad_vaos_;
+};
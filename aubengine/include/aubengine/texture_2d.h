@@ -2,13 +2,16 @@
 
 #include <glad/gl.h>
 
+#include <atomic>
+#include <cstdint>
+
 // Texture2D is able to store and configure a texture in OpenGL.
 // It also hosts utility functions for easy management.
 class Texture2D {
  public:
   // holds the ID of the texture object, used for all texture operations to
   // reference to this particlar texture
-  unsigned int ID;
+  unsigned int ID = 0;
   // texture image dimensions
   unsigned int Width, Height;  // width and height of loaded image in pixels
   // texture Format
@@ -19,11 +22,27 @@ class Texture2D {
   unsigned int Wrap_T;      // wrapping mode on T axis
   unsigned int Filter_Min;  // filtering mode if texture pixels < screen pixels
   unsigned int Filter_Max;  // filtering mode if texture pixels > screen pixels
+  // residency, maintained by ResourceManager: whether the image is in GPU
+  // memory, the frame the texture was last bound in, and whether a bind found
+  // it evicted and asked for it to be streamed back in; all three are atomic
+  // as windows rendering on threads of their own bind at the same time
+  std::atomic<bool> resident = false;
+  mutable std::atomic<uint64_t> last_used_frame = 0;
+  mutable std::atomic<bool> stream_in_requested = false;
+  // frame counter advanced by ResourceManager at every frame boundary
+  static uint64_t current_frame;
   // constructor (sets default texture modes)
   Texture2D(GladGLContext* context);
-  // generates texture from image data
+  // generates texture from image data, recreating the texture object if it
+  // was released
   void Generate(unsigned int width, unsigned int height, unsigned char* data);
-  // binds the texture as the current active GL_TEXTURE_2D texture object
+  // deletes the texture object to free its GPU memory; dimensions and modes
+  // are kept so that Generate can bring it back
+  void Release();
+  // GPU memory taken by the image when resident
+  uint64_t SizeInBytes() const;
+  // binds the texture as the current active GL_TEXTURE_2D texture object; an
+  // evicted texture binds nothing (and samples black) until streamed back in
   void Bind() const;
 
  private:
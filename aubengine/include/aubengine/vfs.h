@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class MountedPack;
+
+// Contents of a file read through the VirtualFileSystem. Entries stored
+// uncompressed in a pack are a view straight into its mapping; decompressed
+// entries and loose files own their bytes.
+class VfsFile {
+ public:
+  VfsFile() = default;
+  VfsFile(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+  VfsFile(std::vector<uint8_t> bytes)
+      : bytes_(std::move(bytes)), data_(bytes_.data()), size_(bytes_.size()) {}
+
+  VfsFile(const VfsFile&) = delete;
+  void operator=(const VfsFile&) = delete;
+  VfsFile(VfsFile&& other) noexcept { *this = std::move(other); }
+  VfsFile& operator=(VfsFile&& other) noexcept;
+
+  const uint8_t* Data() const { return data_; }
+  size_t Size() const { return size_; }
+  std::string_view Text() const {
+    return {reinterpret_cast<const char*>(data_), size_};
+  }
+  explicit operator bool() const { return data_ != nullptr; }
+
+ private:
+  std::vector<uint8_t> bytes_;
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// A static VirtualFileSystem that resolves asset paths against mounted pack
+// files first and the loose file system second. Each pack is memory mapped
+// once at Mount, so reading an asset from it costs a binary search and, for
+// compressed entries, an LZ4 decode; no file is opened per asset.
+// Packs must be mounted before assets are read, Read itself may be called
+// from any thread.
+class VirtualFileSystem {
+ public:
+  // maps pack_file and serves its entries under mount_point, so the entry
+  // "textures/block.png" mounted at "assets" answers Read("assets/textures/
+  // block.png"); packs mounted later take precedence
+  static bool Mount(const std::string& pack_file,
+                    const std::string& mount_point = "");
+  // unmaps every pack; files read from them must not be used afterwards
+  static void UnmountAll();
+  static bool Exists(const std::string& path);
+  // returns an empty VfsFile if path is neither in a pack nor on disk
+  static VfsFile Read(const std::string& path);
+
+ private:
+  VirtualFileSystem() {}
+
+  static std::vector<std::unique_ptr<MountedPack>> packs_;
+};
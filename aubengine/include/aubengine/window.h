@@ -14,17 +14,23 @@ class Window {
   virtual void Close() = 0;
   virtual bool WindowShouldClose() = 0;
   virtual void* GetWindowNative() = 0;
+  // nullptr for a window without a GL context, or once closed
   virtual void* GetContext() = 0;
+  // Makes the window's context current on the calling thread, and
+  // Release makes it current on none, so that another thread can take it.
   virtual void Use() = 0;
+  virtual void Release() = 0;
   virtual void Begin() = 0;
   virtual void End() = 0;
   virtual void PhysicsUpdate() = 0;
   virtual void Update() = 0;
-  virtual void Render() = 0;
+  // alpha is how far rendering is between the previous and the current tick
+  virtual void Render(float alpha) = 0;
   virtual bool GetVSync() = 0;
   virtual void SetVSync(bool isEnabled) = 0;
 
   virtual void SetScene(std::shared_ptr<Scene> scene) = 0;
+  Scene* GetScene() { return scene_.get(); }
 
  protected:
   bool v_sync_ = false;
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "aubengine/window.h"
+
+// Window of the RenderAPI::NONE backend, for dedicated servers and CI: no
+// GLFW window and no graphics context. Its scene is simulated as usual but
+// never drawn, and GetContext returns nullptr, which components and the
+// ResourceManager take as "skip the GPU work".
+class WindowNull : public Window {
+ public:
+  virtual bool Initialize(const std::string& name, uint32_t width,
+                          uint32_t height) override;
+  virtual void Close() override;
+  virtual bool WindowShouldClose() override;
+  virtual void* GetWindowNative() override;
+  virtual void* GetContext() override;
+  virtual void Begin() override;
+  virtual void End() override;
+  virtual void PhysicsUpdate() override;
+  virtual void Update() override;
+  virtual void Render(float alpha) override;
+  virtual void Use() override;
+  virtual void Release() override;
+  virtual bool GetVSync() override;
+  virtual void SetVSync(bool isEnabled) override;
+  virtual void SetScene(std::shared_ptr<Scene> scene) override;
+
+ private:
+  bool should_close_ = false;
+};
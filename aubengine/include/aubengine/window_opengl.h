@@ -5,8 +5,10 @@
 // clang-format on
 #include <GLFW/glfw3.h>
 
+#include <atomic>
 #include <unordered_map>
 
+#include "aubengine/profiler.h"
 #include "aubengine/window.h"
 
 class WindowOpenGL : public Window {
@@ -23,14 +25,28 @@ class WindowOpenGL : public Window {
   virtual void End() override;
   virtual void PhysicsUpdate() override;
   virtual void Update() override;
-  virtual void Render() override;
+  virtual void Render(float alpha) override;
   virtual void Use() override;
+  virtual void Release() override;
   virtual bool GetVSync() override;
   virtual void SetVSync(bool isEnabled) override;
   virtual void SetScene(std::shared_ptr<Scene> scene) override;
 
+  // Pumps the events of every window, once a frame, on the main thread.
+  static void PollEvents();
+
  private:
   GLFWwindow* window_ = nullptr;
   GladGLContext* context_ = nullptr;
+  GpuTimer gpu_timer_;
+  // Resizes and VSync changes come from the main thread, but must apply
+  // to the context on whichever thread renders the window, so Render and
+  // End pick them up.
+  std::atomic<bool> resized_ = false;
+  std::atomic<int> width_ = 0;
+  std::atomic<int> height_ = 0;
+  std::atomic<bool> v_sync_changed_ = false;
   static uint8_t window_opengl_instances_count_;
+  // window whose context all the others share their objects with
+  static GLFWwindow* share_window_;
 };
\ No newline at end of file
@@ -1,11 +1,18 @@
 #include "aubengine/application.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <iostream>
+#include <thread>
 
-#include "aubengine/components/rigid_body_2d.h"
 #include "aubengine/input.h"
+#include "aubengine/metrics.h"
+#include "aubengine/profiler.h"
 #include "aubengine/resource_manager.h"
+#include "aubengine/scene.h"
+#include "aubengine/window_null.h"
 #include "aubengine/window_opengl.h"
 
 namespace Aubengine {
@@ -15,10 +22,54 @@ Application& Application::GetInstance() {
 }
 
 Application& Application::SetUpdateRate(uint32_t hz) {
+  if (hz == 0) {
+    hz = kDefaultUpdateRate;
+  }
   hz_ = hz;
+  requested_hz_ = hz;
+  return *this;
+}
+
+Application& Application::SetMaxCatchUpSteps(uint32_t steps) {
+  max_catch_up_steps_ = steps;
+  return *this;
+}
+
+Application& Application::SetMaxLag(uint64_t nanoseconds) {
+  max_lag_ = nanoseconds;
+  return *this;
+}
+
+Application& Application::SetAdaptiveUpdateRate(bool enabled,
+                                                uint32_t min_hz) {
+  adaptive_update_rate_ = enabled;
+  // the rate is divided by, so it never backs off to nothing
+  min_hz_ = std::max(min_hz, 1u);
   return *this;
 }
 
+Application& Application::SetTargetFrameRate(uint32_t fps) {
+  target_fps_ = fps;
+  return *this;
+}
+
+FramePacingStats Application::GetFramePacingStats() {
+  FramePacingStats stats;
+  stats.frames = frames_;
+  stats.slept_nanoseconds = frame_limiter_.SleptNanoseconds() +
+                            simulation_limiter_.SleptNanoseconds();
+  stats.spun_nanoseconds = frame_limiter_.SpunNanoseconds() +
+                           simulation_limiter_.SpunNanoseconds();
+  return stats;
+}
+
+SimulationStats Application::GetSimulationStats() {
+  std::scoped_lock lock(stats_mutex_);
+  SimulationStats stats = stats_;
+  stats.update_rate = hz_;
+  return stats;
+}
+
 uint64_t Application::MillisecondsPerUpdate() { return 1000LL / hz_; }
 uint64_t Application::NanosecondsPerUpdate() { return 1000000000LL / hz_; }
 
@@ -26,16 +77,150 @@ void Application::Run(uint32_t hz) {
   SetUpdateRate(hz);
   Run();
 }
+Application& Application::SetThreadedSimulation(bool enabled) {
+  threaded_simulation_ = enabled;
+  return *this;
+}
+
+Application& Application::SetRenderThreads(bool enabled) {
+  render_threads_enabled_ = enabled;
+  return *this;
+}
+
 void Application::Run() {
-  auto previous = std::chrono::steady_clock::now();
-  uint64_t lag = 0;
+  quit_ = false;
+  if (render_threads_enabled_) {
+    StartRenderThreads();
+  }
+  // with nothing to draw there is nothing to overlap the simulation with
+  if (threaded_simulation_ && !IsHeadless()) {
+    RunThreaded();
+  } else {
+    RunSingleThreaded();
+  }
+  StopRenderThreads();
+
+  // Resources are shared by every window's context, so they are released
+  // exactly once, through the first window whose context is still alive;
+  // with none left (headless, or all closed) only the handles are dropped.
+  Window* owner = nullptr;
+  for (const auto& window : windows) {
+    if (window->GetContext() != nullptr) {
+      owner = window.get();
+      break;
+    }
+  }
+  if (owner) {
+    owner->Use();
+  }
+  ResourceManager::Clear(
+      owner ? static_cast<GladGLContext*>(owner->GetContext()) : nullptr);
+}
+
+void Application::Quit() { quit_ = true; }
+
+void Application::StartRenderThreads() {
+  for (const auto& window : windows) {
+    if (window->GetContext() == nullptr) {
+      continue;
+    }
+    // a context can only be current on one thread at a time
+    window->Release();
+    auto renderThread = std::make_unique<RenderThread>();
+    renderThread->window = window.get();
+    renderThread->thread = std::thread(
+        [this, renderThread = renderThread.get()]() {
+          RunRenderThread(*renderThread);
+        });
+    render_threads_.push_back(std::move(renderThread));
+  }
+}
+
+void Application::StopRenderThreads() {
+  for (const auto& renderThread : render_threads_) {
+    {
+      std::scoped_lock lock(renderThread->mutex);
+      renderThread->stopping = true;
+    }
+    renderThread->condition.notify_all();
+    renderThread->thread.join();
+  }
+  render_threads_.clear();
+}
+
+void Application::RunRenderThread(RenderThread& renderThread) {
+  renderThread.window->Use();
   while (true) {
-    bool shouldClose = false;
-    for (const auto& window : windows) {
-      shouldClose |= window->WindowShouldClose();
+    std::function<void()> job;
+    {
+      std::unique_lock lock(renderThread.mutex);
+      renderThread.condition.wait(lock, [&renderThread]() {
+        return renderThread.busy || renderThread.stopping;
+      });
+      if (!renderThread.busy) {
+        break;
+      }
+      job = std::move(renderThread.job);
+    }
+    job();
+    {
+      std::scoped_lock lock(renderThread.mutex);
+      renderThread.busy = false;
     }
+    renderThread.condition.notify_all();
+  }
+  // handed back, for the main thread to release resources through
+  renderThread.window->Release();
+}
+
+void Application::Dispatch(RenderThread& renderThread,
+                           std::function<void()> job) {
+  {
+    std::scoped_lock lock(renderThread.mutex);
+    renderThread.job = std::move(job);
+    renderThread.busy = true;
+  }
+  renderThread.condition.notify_all();
+}
+
+void Application::Wait(RenderThread& renderThread) {
+  std::unique_lock lock(renderThread.mutex);
+  renderThread.condition.wait(lock,
+                              [&renderThread]() { return !renderThread.busy; });
+}
+
+void Application::PollWindowEvents() {
+  WindowOpenGL::PollEvents();
+  for (const auto& window : windows) {
+    window->Begin();
+  }
+}
+
+void Application::UpdateResources() {
+  // Uploads and evictions touch objects every window draws with, so they
+  // finish before any window starts drawing.
+  if (!render_threads_.empty()) {
+    Dispatch(*render_threads_.front(), []() { ResourceManager::Update(); });
+    Wait(*render_threads_.front());
+    return;
+  }
+  ResourceManager::Update();
+}
 
-    if (shouldClose) {
+bool Application::ShouldClose() {
+  bool shouldClose = quit_;
+  for (const auto& window : windows) {
+    shouldClose |= window->WindowShouldClose();
+  }
+  return shouldClose;
+}
+
+void Application::RunSingleThreaded() {
+  auto previous = std::chrono::steady_clock::now();
+  auto nextFrame = previous;
+  uint64_t lag = 0;
+  while (true) {
+    if (ShouldClose()) {
       break;
     }
 
@@ -48,48 +233,250 @@ void Application::Run() {
     previous = current;
     lag += elapsed;
 
-    while (lag >= NanosecondsPerUpdate()) {
-      PollInput();
-      PhysicsUpdate();
-      Update();
-      lag -= NanosecondsPerUpdate();
+    CatchUp(lag, true);
+    auto nextTick = current + UntilNextTick(lag);
+
+    if (IsHeadless()) {
+      // Nothing is drawn, so rather than spinning until the next tick is due
+      // the thread sleeps, leaving the core to other server instances.
+      Metrics::EndFrame();
+      frame_limiter_.WaitUntil(nextTick);
+      continue;
+    }
+
+    if (target_fps_ == 0 || current >= nextFrame) {
+      AUBENGINE_PROFILE_SCOPE("Frame");
+      UpdateResources();
+      // the leftover lag is how far we are into the next tick, so the frame
+      // shows the state that far between the last two ticks
+      Render(std::min(float(lag) / NanosecondsPerUpdate(), 1.0f));
+      FinishFrame();
+      nextFrame = NextFrameDeadline(nextFrame, current);
     }
 
-    Render();
+    // Uncapped, the loop renders again straight away (or blocks in the swap
+    // with VSync); capped, it sleeps until a frame or a tick is due.
+    if (target_fps_ != 0) {
+      frame_limiter_.WaitUntil(std::min(nextTick, nextFrame));
+    }
   }
+}
 
+void Application::RunThreaded() {
+  std::atomic<bool> running = true;
+
+  // from the first frame on, scenes must be drawn from captures only
   for (const auto& window : windows) {
-    ResourceManager::Clear((GladGLContext*)window->GetContext());
+    if (window->GetScene()) {
+      window->GetScene()->PublishRenderState();
+    }
+  }
+
+  // Window events must be pumped on the main thread, and GLFW may only be
+  // called from there, so the simulation thread never touches it: it only
+  // takes the input events the main thread queued, steps and publishes
+  // render state.
+  std::thread simulation([this, &running]() {
+    auto previous = std::chrono::steady_clock::now();
+    uint64_t lag = 0;
+    while (running) {
+      auto current = std::chrono::steady_clock::now();
+      lag += std::chrono::duration_cast<std::chrono::nanoseconds>(current -
+                                                                  previous)
+                 .count();
+      previous = current;
+
+      bool ticked = lag >= NanosecondsPerUpdate();
+      CatchUp(lag, false);
+
+      if (ticked) {
+        for (const auto& window : windows) {
+          if (window->GetScene()) {
+            window->GetScene()->PublishRenderState();
+          }
+        }
+      }
+
+      simulation_limiter_.WaitUntil(current + UntilNextTick(lag));
+    }
+  });
+
+  auto nextFrame = std::chrono::steady_clock::now();
+  while (!ShouldClose()) {
+    {
+      AUBENGINE_PROFILE_SCOPE("Frame");
+      PollWindowEvents();
+      UpdateResources();
+      // each scene works out its blend factor from its latest capture
+      Render(1.0f);
+    }
+    FinishFrame();
+
+    if (target_fps_ != 0) {
+      auto now = std::chrono::steady_clock::now();
+      nextFrame = NextFrameDeadline(nextFrame, now);
+      frame_limiter_.WaitUntil(nextFrame);
+    }
   }
+
+  running = false;
+  simulation.join();
 }
 
-void Application::PollInput() {
-  for (const auto& window : windows) {
-    window->Begin();
+void Application::FinishFrame() {
+  static MetricHistogram& frameTime = Metrics::GetHistogram("frame.time_ms");
+  auto now = std::chrono::steady_clock::now();
+  if (frames_ != 0) {
+    frameTime.Observe(
+        std::chrono::duration<double, std::milli>(now - last_frame_end_)
+            .count());
+  }
+  last_frame_end_ = now;
+  ++frames_;
+  Metrics::EndFrame();
+}
+
+std::chrono::steady_clock::time_point Application::NextFrameDeadline(
+    std::chrono::steady_clock::time_point deadline,
+    std::chrono::steady_clock::time_point now) {
+  if (target_fps_ == 0) {
+    return now;
+  }
+
+  // Deadlines advance by whole frames so the rate does not drift, but a
+  // frame that ran late restarts the schedule rather than being followed by
+  // a burst of frames to catch up.
+  auto frame = std::chrono::nanoseconds(1000000000LL / target_fps_);
+  deadline += frame;
+  if (deadline < now) {
+    deadline = now + frame;
+  }
+  return deadline;
+}
+
+void Application::CatchUp(uint64_t& lag, bool pollWindowEvents) {
+  uint64_t dropped = 0;
+  if (max_lag_ != 0 && lag > max_lag_) {
+    dropped += lag - max_lag_;
+    lag = max_lag_;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  uint32_t steps = 0;
+  bool overloaded = false;
+  while (lag >= NanosecondsPerUpdate()) {
+    if (max_catch_up_steps_ != 0 && steps == max_catch_up_steps_) {
+      // Running more ticks would only make the next frame later still, so
+      // whole ticks are given up; the remainder is kept for interpolation.
+      uint64_t whole = lag - lag % NanosecondsPerUpdate();
+      dropped += whole;
+      lag -= whole;
+      overloaded = true;
+      break;
+    }
+
+    if (pollWindowEvents) {
+      PollInput();
+    } else {
+      Input::PollInput();
+    }
+    PhysicsUpdate();
+    Update();
+    lag -= NanosecondsPerUpdate();
+    ++steps;
+  }
+
+  if (steps != 0 || dropped != 0) {
+    std::scoped_lock lock(stats_mutex_);
+    stats_.ticks += steps;
+    stats_.dropped_nanoseconds += dropped;
+    stats_.dropped_ticks += dropped / NanosecondsPerUpdate();
+    stats_.overloaded_frames += overloaded;
+  }
+
+  if (steps != 0) {
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+    AdaptUpdateRate(steps, elapsed / steps);
+  }
+}
+
+std::chrono::nanoseconds Application::UntilNextTick(uint64_t lag) {
+  // a rate raised since lag was last drawn down can leave it past a period
+  uint64_t period = NanosecondsPerUpdate();
+  return std::chrono::nanoseconds(lag >= period ? 0 : period - lag);
+}
+
+void Application::AdaptUpdateRate(uint32_t ticks,
+                                  uint64_t nanosecondsPerTick) {
+  if (!adaptive_update_rate_) {
+    return;
+  }
+
+  // Smoothed over roughly the last twenty ticks, and acted upon at most once
+  // per second of ticks, so a single hitch does not change the rate.
+  double keep = std::pow(0.95, ticks);
+  average_tick_nanoseconds_ =
+      average_tick_nanoseconds_ * keep + nanosecondsPerTick * (1.0 - keep);
+  ticks_since_rate_change_ += ticks;
+  if (ticks_since_rate_change_ < hz_) {
+    return;
+  }
+
+  uint32_t hz = hz_;
+  double step = double(NanosecondsPerUpdate());
+  if (average_tick_nanoseconds_ > step * 0.9 && hz > min_hz_) {
+    hz = std::max({min_hz_, hz * 9 / 10, 1u});
+  } else if (average_tick_nanoseconds_ < step * 0.5 && hz < requested_hz_) {
+    hz = std::min(requested_hz_, hz * 11 / 10 + 1);
+  }
+
+  if (hz != hz_) {
+    hz_ = hz;
+    ticks_since_rate_change_ = 0;
   }
-  Input::PollInput();
 }
 
-int32_t velocityIterations = 6;
-int32_t positionIterations = 2;
+void Application::PollInput() {
+  AUBENGINE_PROFILE_SCOPE("Application::PollInput");
+  PollWindowEvents();
+  Input::PollInput();
+}
 
 void Application::PhysicsUpdate() {
+  AUBENGINE_PROFILE_SCOPE("Application::PhysicsUpdate");
   for (const auto& window : windows) {
     window->PhysicsUpdate();
   }
-
-  RigidBody2D::world.Step(1.0 / hz_, velocityIterations, positionIterations);
 }
 
 void Application::Update() {
+  AUBENGINE_PROFILE_SCOPE("Application::Update");
   for (const auto& window : windows) {
     window->Update();
   }
 }
 
-void Application::Render() {
+void Application::Render(float alpha) {
+  AUBENGINE_PROFILE_SCOPE("Application::Render");
+  if (!render_threads_.empty()) {
+    // every window draws and presents at once, so the frame takes as long
+    // as the slowest of them rather than all of them in turn
+    for (const auto& renderThread : render_threads_) {
+      Window* window = renderThread->window;
+      Dispatch(*renderThread, [window, alpha]() {
+        window->Render(alpha);
+        window->End();
+      });
+    }
+    for (const auto& renderThread : render_threads_) {
+      Wait(*renderThread);
+    }
+    return;
+  }
   for (const auto& window : windows) {
-    window->Render();
+    window->Render(alpha);
     window->End();
   }
 }
@@ -99,4 +486,19 @@ Window* Application::CreateWindowOpenGL() {
   windows.push_back(window);
   return window.get();
 }
+
+Window* Application::CreateWindowNull() {
+  std::shared_ptr<Window> window = std::make_shared<WindowNull>();
+  windows.push_back(window);
+  return window.get();
+}
+
+bool Application::IsHeadless() {
+  for (const auto& window : windows) {
+    if (window->GetContext() != nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
 }  // namespace Aubengine
\ No newline at end of file
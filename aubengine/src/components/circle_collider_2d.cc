@@ -0,0 +1,14 @@
+#include "aubengine/components/circle_collider_2d.h"
+
+#include "aubengine/game_object.h"
+
+CircleCollider2D::CircleCollider2D() {}
+CircleCollider2D::CircleCollider2D(float radius) : radius(radius) {}
+
+void CircleCollider2D::BuildShapes() {
+  const glm::vec3& size = game_object->transform->size;
+  b2CircleShape circle;
+  circle.m_radius = radius * size.x;
+  circle.m_p.Set(offset.x * size.x, offset.y * size.y);
+  AddShape(circle);
+}
@@ -0,0 +1,78 @@
+#include "aubengine/components/collider_2d.h"
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "aubengine/game_object.h"
+
+// Baked shapes, by the exact values they were built from. Sizes that keep
+// changing would grow the caches for good, so each is emptied once full.
+static constexpr size_t kMaxBakedShapes = 1024;
+static std::mutex shapes_mutex_;
+static std::map<std::pair<float, float>, b2PolygonShape> boxes_;
+static std::map<std::vector<float>, b2PolygonShape> polygons_;
+
+Collider2D::~Collider2D() {
+  // a body going away takes its fixtures along, so only a collider removed
+  // from an object that keeps its body destroys its fixtures
+  if (fixtures_.empty()) {
+    return;
+  }
+  RigidBody2D* rigidBody = game_object->rigid_body_2d.get();
+  if (rigidBody != nullptr && rigidBody->body == body_) {
+    for (b2Fixture* fixture : fixtures_) {
+      rigidBody->HandleRemovedCollider(fixture);
+    }
+  }
+}
+
+void Collider2D::Start() {
+  if (!game_object->rigid_body_2d) {
+    return;
+  }
+  body_ = game_object->rigid_body_2d->body;
+  BuildShapes();
+}
+
+void Collider2D::AddShape(const b2Shape& shape) {
+  b2FixtureDef fixtureDef;
+  fixtureDef.shape = &shape;
+  fixtureDef.density = density;
+  fixtureDef.friction = friction;
+  fixtureDef.isSensor = is_trigger;
+  fixtures_.push_back(
+      game_object->rigid_body_2d->HandleNewCollider(fixtureDef));
+}
+
+b2PolygonShape Collider2D::BakedBox(float halfWidth, float halfHeight) {
+  std::scoped_lock lock(shapes_mutex_);
+  if (boxes_.size() == kMaxBakedShapes) {
+    boxes_.clear();
+  }
+  auto [it, inserted] = boxes_.try_emplace({halfWidth, halfHeight});
+  if (inserted) {
+    it->second.SetAsBox(halfWidth, halfHeight);
+  }
+  return it->second;
+}
+
+b2PolygonShape Collider2D::BakedPolygon(
+    std::span<const b2Vec2> points) {
+  std::vector<float> key;
+  key.reserve(points.size() * 2);
+  for (const b2Vec2& point : points) {
+    key.push_back(point.x);
+    key.push_back(point.y);
+  }
+
+  std::scoped_lock lock(shapes_mutex_);
+  if (polygons_.size() == kMaxBakedShapes) {
+    polygons_.clear();
+  }
+  auto [it, inserted] = polygons_.try_emplace(std::move(key));
+  if (inserted) {
+    it->second.Set(points.data(), int32(points.size()));
+  }
+  return it->second;
+}
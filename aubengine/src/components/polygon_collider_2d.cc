@@ -0,0 +1,39 @@
+#include "aubengine/components/polygon_collider_2d.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "aubengine/game_object.h"
+
+PolygonCollider2D::PolygonCollider2D(std::vector<glm::vec2> points)
+    : points(std::move(points)) {}
+
+void PolygonCollider2D::BuildShapes() {
+  size_t count = points.size();
+  if (count < 3) {
+    return;
+  }
+
+  const glm::vec3& size = game_object->transform->size;
+  std::vector<b2Vec2> scaled;
+  scaled.reserve(count);
+  for (const glm::vec2& point : points) {
+    scaled.emplace_back(point.x * size.x, point.y * size.y);
+  }
+
+  if (count <= b2_maxPolygonVertices) {
+    AddShape(BakedPolygon(scaled));
+    return;
+  }
+
+  // each piece is the first vertex followed by a run of the others, the
+  // last vertex of a run starting the next one
+  b2Vec2 piece[b2_maxPolygonVertices];
+  piece[0] = scaled[0];
+  for (size_t start = 1; start + 1 < count;) {
+    size_t end = std::min(start + b2_maxPolygonVertices - 2, count - 1);
+    std::copy(scaled.begin() + start, scaled.begin() + end + 1, piece + 1);
+    AddShape(BakedPolygon({piece, end - start + 2}));
+    start = end;
+  }
+}
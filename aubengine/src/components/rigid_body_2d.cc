@@ -4,16 +4,32 @@
 
 #include "aubengine/components/transform.h"
 #include "aubengine/game_object.h"
-
-b2World RigidBody2D::world({0.0f, -10.0f});
+#include "aubengine/metrics.h"
+#include "aubengine/scene.h"
+#include "aubengine/snapshot.h"
 
 RigidBody2D::RigidBody2D() : body_type(RigidBody2D::BodyType::kStatic) {}
 
 RigidBody2D::RigidBody2D(RigidBody2D::BodyType body_type)
     : body_type(body_type) {}
 
+RigidBody2D::~RigidBody2D() {
+  if (body != nullptr) {
+    world_->DestroyBody(body);
+  }
+}
+
+void RigidBody2D::Detach() { body = nullptr; }
+
+void RigidBody2D::SetEnabled(bool enabled) {
+  if (body == nullptr) {
+    return;
+  }
+  world_->SetEnabled(body, enabled);
+}
+
 void RigidBody2D::ChangeGravity(const b2Vec2& gravity) {
-  world.SetGravity(gravity);
+  world_->SetGravity(gravity);
 }
 
 void RigidBody2D::Start() {
@@ -21,17 +37,129 @@ void RigidBody2D::Start() {
   bodyDef.type = (b2BodyType)body_type;
   auto pos = game_object->transform->position;
   bodyDef.position.Set(pos.x, pos.y);
-  body = world.CreateBody(&bodyDef);
+  bodyDef.angle = glm::radians(game_object->transform->euler_rotation.z);
+  world_ = &game_object->GetScene()->GetPhysicsWorld();
+  body = world_->CreateBody(bodyDef, this);
+  // the body starts out where the Transform is
+  synced_position_ = game_object->transform->position;
+  synced_rotation_ = game_object->transform->euler_rotation;
+  synced_revision_ = world_->GetState(body).revision;
 }
 
-void RigidBody2D::PhysicsUpdate() {
-  body->SetTransform(
-      {game_object->transform->position.x, game_object->transform->position.y},
-      game_object->transform->euler_rotation.x);
+void RigidBody2D::Update() {}
+
+void RigidBody2D::SaveState(SnapshotWriter& writer) const {
+  if (body == nullptr) {
+    return;
+  }
+  writer.Write(world_->SaveBody(body));
+  writer.Write(synced_position_);
+  writer.Write(synced_rotation_);
+  // whether a step moved the body since the Transform last pulled its pose
+  writer.Write(uint8_t(world_->GetState(body).revision != synced_revision_));
 }
 
-void RigidBody2D::Update() {}
+void RigidBody2D::LoadState(SnapshotReader& reader) {
+  if (body == nullptr) {
+    return;
+  }
+  PhysicsBodySnapshot snapshot;
+  uint8_t unpulled = 0;
+  reader.Read(snapshot);
+  reader.Read(synced_position_);
+  reader.Read(synced_rotation_);
+  reader.Read(unpulled);
+  uint64_t revision = world_->RestoreBody(body, snapshot);
+  synced_revision_ = unpulled ? revision - 1 : revision;
+}
 
-void RigidBody2D::HandleNewCollider(const b2FixtureDef& fixtureDef) {
-  body->CreateFixture(&fixtureDef);
-}
\ No newline at end of file
+b2Fixture* RigidBody2D::HandleNewCollider(const b2FixtureDef& fixtureDef) {
+  if (body == nullptr) {
+    return nullptr;
+  }
+  return world_->CreateFixture(body, fixtureDef);
+}
+
+void RigidBody2D::HandleRemovedCollider(b2Fixture* fixture) {
+  if (body == nullptr) {
+    return;
+  }
+  world_->DestroyFixture(body, fixture);
+}
+
+void RigidBody2D::SetLinearVelocity(const b2Vec2& velocity) {
+  // a detached body is gone along with its world, or about to be
+  if (body == nullptr) {
+    return;
+  }
+  PhysicsCommand command;
+  command.type = PhysicsCommand::Type::kSetLinearVelocity;
+  command.body = body;
+  command.vector = velocity;
+  world_->Enqueue(command);
+}
+
+void RigidBody2D::ApplyForce(const b2Vec2& force) {
+  if (body == nullptr) {
+    return;
+  }
+  PhysicsCommand command;
+  command.type = PhysicsCommand::Type::kApplyForce;
+  command.body = body;
+  command.vector = force;
+  world_->Enqueue(command);
+}
+
+void RigidBody2D::ApplyLinearImpulse(const b2Vec2& impulse) {
+  if (body == nullptr) {
+    return;
+  }
+  PhysicsCommand command;
+  command.type = PhysicsCommand::Type::kApplyLinearImpulse;
+  command.body = body;
+  command.vector = impulse;
+  world_->Enqueue(command);
+}
+
+void RigidBody2D::PullTransform() {
+  if (body == nullptr) {
+    return;
+  }
+  const PhysicsBodyState& state = world_->GetState(body);
+  if (state.revision == synced_revision_) {
+    return;
+  }
+
+  static MetricCounter& pulled = Metrics::GetCounter("physics.pulls");
+  pulled.Add();
+  Transform* transform = game_object->transform.get();
+  transform->position.x = state.position.x;
+  transform->position.y = state.position.y;
+  transform->euler_rotation.z = glm::degrees(state.angle);
+  synced_position_ = transform->position;
+  synced_rotation_ = transform->euler_rotation;
+  synced_revision_ = state.revision;
+}
+
+void RigidBody2D::PushTransform(std::vector<PhysicsCommand>& commands) {
+  if (body == nullptr) {
+    return;
+  }
+  const Transform* transform = game_object->transform.get();
+  if (transform->position == synced_position_ &&
+      transform->euler_rotation == synced_rotation_) {
+    return;
+  }
+
+  static MetricCounter& pushed = Metrics::GetCounter("physics.pushes");
+  pushed.Add();
+  PhysicsCommand command;
+  command.type = PhysicsCommand::Type::kSetTransform;
+  command.body = body;
+  command.vector = {transform->position.x, transform->position.y};
+  // the renderer rotates sprites about z, in degrees
+  command.angle = glm::radians(transform->euler_rotation.z);
+  commands.push_back(command);
+  synced_position_ = transform->position;
+  synced_rotation_ = transform->euler_rotation;
+}
@@ -0,0 +1,129 @@
+#include "aubengine/components/tilemap_collider_2d.h"
+
+#include <array>
+#include <utility>
+
+TilemapCollider2D::TilemapCollider2D(uint32_t width, uint32_t height,
+                                     float tile_size,
+                                     std::vector<uint8_t> tiles)
+    : width(width),
+      height(height),
+      tile_size(tile_size),
+      tiles(std::move(tiles)) {
+  // missing tiles are empty, extra ones ignored
+  this->tiles.resize(size_t(width) * height);
+}
+
+bool TilemapCollider2D::IsSolid(int32_t x, int32_t y) const {
+  if (x < 0 || y < 0 || x >= int32_t(width) || y >= int32_t(height)) {
+    return false;
+  }
+  return tiles[size_t(y) * width + x] != 0;
+}
+
+void TilemapCollider2D::BuildShapes() {
+  if (!baked_) {
+    Bake();
+    baked_ = true;
+  }
+
+  for (const auto& loop : loops_) {
+    b2ChainShape chain;
+    chain.CreateLoop(loop.data(), int32(loop.size()));
+    AddShape(chain);
+  }
+}
+
+void TilemapCollider2D::Bake() {
+  // Every side of a solid tile facing an empty one is an edge between two
+  // tile corners, directed so the solid side is on its left: one-sided
+  // chains then face out of the solid areas. Corners are numbered row by
+  // row.
+  struct Edge {
+    int32_t from = 0;
+    int32_t to = 0;
+    bool used = false;
+  };
+  int32_t columns = int32_t(width) + 1;
+  std::vector<Edge> edges;
+  // Edges leaving each corner. Only a corner where two solid tiles touch
+  // diagonally has two.
+  std::vector<std::array<int32_t, 2>> outgoing(
+      size_t(columns) * (height + 1), {-1, -1});
+  auto corner = [columns](int32_t x, int32_t y) { return y * columns + x; };
+  auto addEdge = [&](int32_t from, int32_t to) {
+    auto& slots = outgoing[from];
+    slots[slots[0] == -1 ? 0 : 1] = int32_t(edges.size());
+    edges.push_back({from, to, false});
+  };
+  for (int32_t y = 0; y < int32_t(height); ++y) {
+    for (int32_t x = 0; x < int32_t(width); ++x) {
+      if (!IsSolid(x, y)) {
+        continue;
+      }
+      if (!IsSolid(x, y - 1)) {
+        addEdge(corner(x, y), corner(x + 1, y));
+      }
+      if (!IsSolid(x + 1, y)) {
+        addEdge(corner(x + 1, y), corner(x + 1, y + 1));
+      }
+      if (!IsSolid(x, y + 1)) {
+        addEdge(corner(x + 1, y + 1), corner(x, y + 1));
+      }
+      if (!IsSolid(x - 1, y)) {
+        addEdge(corner(x, y + 1), corner(x, y));
+      }
+    }
+  }
+
+  auto direction = [columns](const Edge& edge) {
+    return std::pair(edge.to % columns - edge.from % columns,
+                     edge.to / columns - edge.from / columns);
+  };
+
+  // Following the edges end to start traces each outline once. Where two
+  // areas touch diagonally, turning left keeps to the area being traced, so
+  // areas sharing a corner still get loops of their own.
+  loops_.clear();
+  for (size_t first = 0; first < edges.size(); ++first) {
+    if (edges[first].used) {
+      continue;
+    }
+
+    std::vector<b2Vec2> loop;
+    auto firstDirection = direction(edges[first]);
+    auto lastDirection = std::pair(0, 0);
+    int32_t current = int32_t(first);
+    while (current != -1) {
+      Edge& edge = edges[current];
+      edge.used = true;
+      // corners the outline goes straight through are left out
+      auto edgeDirection = direction(edge);
+      if (loop.empty() || edgeDirection != lastDirection) {
+        loop.emplace_back(float(edge.from % columns) * tile_size,
+                          float(edge.from / columns) * tile_size);
+      }
+      lastDirection = edgeDirection;
+
+      const auto& slots = outgoing[edge.to];
+      int32_t next = slots[0];
+      if (slots[1] != -1) {
+        auto [dx, dy] = edgeDirection;
+        auto [nx, ny] = direction(edges[slots[1]]);
+        if (dx * ny - dy * nx > 0) {
+          next = slots[1];
+        }
+      }
+      current = edges[next].used ? -1 : next;
+    }
+
+    // the first corner is straight through too if the loop ends the way it
+    // started
+    if (lastDirection == firstDirection) {
+      loop.erase(loop.begin());
+    }
+    if (loop.size() >= 3) {
+      loops_.push_back(std::move(loop));
+    }
+  }
+}
@@ -4,12 +4,54 @@
 
 #include "aubengine/components/rigid_body_2d.h"
 #include "aubengine/game_object.h"
+#include "aubengine/snapshot.h"
+
+void Transform::PhysicsUpdate() {
+  previous_position = position;
+  previous_euler_rotation = euler_rotation;
+  has_previous_ = true;
+}
 
 void Transform::Update() {
   if (!game_object->rigid_body_2d) {
     return;
   }
 
-  auto pos = game_object->rigid_body_2d->body->GetPosition();
-  position = {pos.x, pos.y, 0};
+  // as of the last finished step, while the next one may be running
+  game_object->rigid_body_2d->PullTransform();
+}
+
+void Transform::SaveState(SnapshotWriter& writer) const {
+  writer.Write(position);
+  writer.Write(size);
+  writer.Write(euler_rotation);
+  writer.Write(previous_position);
+  writer.Write(previous_euler_rotation);
+  writer.Write(uint8_t(has_previous_));
+}
+
+void Transform::LoadState(SnapshotReader& reader) {
+  uint8_t hasPrevious = 0;
+  reader.Read(position);
+  reader.Read(size);
+  reader.Read(euler_rotation);
+  reader.Read(previous_position);
+  reader.Read(previous_euler_rotation);
+  reader.Read(hasPrevious);
+  has_previous_ = hasPrevious != 0;
+}
+
+glm::vec3 Transform::InterpolatedPosition(float alpha) const {
+  if (!has_previous_) {
+    return position;
+  }
+  return previous_position + (position - previous_position) * alpha;
+}
+
+glm::vec3 Transform::InterpolatedEulerRotation(float alpha) const {
+  if (!has_previous_) {
+    return euler_rotation;
+  }
+  return previous_euler_rotation +
+         (euler_rotation - previous_euler_rotation) * alpha;
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "aubengine/file_watcher.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher() {
+#ifdef __linux__
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ < 0) {
+    std::cout << "FileWatcher: inotify unavailable, falling back to polling"
+              << std::endl;
+  }
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+  if (inotify_fd_ >= 0) {
+    close(inotify_fd_);
+  }
+#endif
+}
+
+std::string FileWatcher::Watch(const std::string& path) {
+  std::error_code ec;
+  std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+  std::string key = ec ? path : canonical.string();
+  if (write_times_.count(key)) {
+    return key;
+  }
+  write_times_[key] = std::filesystem::last_write_time(key, ec);
+
+#ifdef __linux__
+  if (inotify_fd_ >= 0) {
+    // Editors usually save by writing a temporary file and renaming it over
+    // the original, which would drop a watch on the file itself, so the
+    // parent directory is watched instead.
+    std::string directory = std::filesystem::path(key).parent_path().string();
+    int wd = inotify_add_watch(inotify_fd_, directory.c_str(),
+                               IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd >= 0) {
+      directories_[wd] = directory;
+    }
+  }
+#endif
+  return key;
+}
+
+std::vector<std::string> FileWatcher::Poll() {
+  std::vector<std::string> changed;
+
+#ifdef __linux__
+  if (inotify_fd_ >= 0) {
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length = 0;
+    while ((length = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+      for (char* p = buffer; p < buffer + length;) {
+        auto* event = reinterpret_cast<inotify_event*>(p);
+        p += sizeof(inotify_event) + event->len;
+
+        auto dir = directories_.find(event->wd);
+        if (dir == directories_.end() || event->len == 0) {
+          continue;
+        }
+        std::string file = (std::filesystem::path(dir->second) / event->name)
+                               .string();
+        if (write_times_.count(file) &&
+            std::find(changed.begin(), changed.end(), file) == changed.end()) {
+          changed.push_back(file);
+        }
+      }
+    }
+    return changed;
+  }
+#endif
+
+  for (auto& [file, write_time] : write_times_) {
+    std::error_code ec;
+    auto current = std::filesystem::last_write_time(file, ec);
+    if (!ec && current != write_time) {
+      write_time = current;
+      changed.push_back(file);
+    }
+  }
+  return changed;
+}
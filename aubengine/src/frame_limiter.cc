@@ -0,0 +1,60 @@
+#include "aubengine/frame_limiter.h"
+
+#include <cmath>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+FrameLimiter::FrameLimiter() {
+#ifdef _WIN32
+  // the default timer resolution turns a 1 ms sleep into up to 15.6 ms
+  timeBeginPeriod(1);
+#endif
+}
+
+FrameLimiter::~FrameLimiter() {
+#ifdef _WIN32
+  timeEndPeriod(1);
+#endif
+}
+
+void FrameLimiter::WaitUntil(std::chrono::steady_clock::time_point deadline) {
+  using namespace std::chrono;
+
+  auto now = steady_clock::now();
+  auto start = now;
+  // Sleep in 1 ms slices for as long as even a late wake-up (mean plus one
+  // standard deviation) would still be before the deadline.
+  while (true) {
+    double remaining =
+        double(duration_cast<nanoseconds>(deadline - now).count());
+    double estimate =
+        sleep_mean_ + std::sqrt(sleep_m2_ / double(sleep_count_));
+    if (remaining <= estimate) {
+      break;
+    }
+
+    std::this_thread::sleep_for(milliseconds(1));
+    auto woke = steady_clock::now();
+    double observed = double(duration_cast<nanoseconds>(woke - now).count());
+    now = woke;
+
+    // Welford's online update
+    ++sleep_count_;
+    double delta = observed - sleep_mean_;
+    sleep_mean_ += delta / double(sleep_count_);
+    sleep_m2_ += delta * (observed - sleep_mean_);
+  }
+  slept_nanoseconds_ += duration_cast<nanoseconds>(now - start).count();
+
+  auto spinStart = now;
+  while (now < deadline) {
+    now = steady_clock::now();
+  }
+  spun_nanoseconds_ += duration_cast<nanoseconds>(now - spinStart).count();
+}
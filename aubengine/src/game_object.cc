@@ -1,12 +1,20 @@
 #include "aubengine/game_object.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "aubengine/components/component.h"
+#include "aubengine/scene.h"
+#include "aubengine/snapshot.h"
 
 GameObject::GameObject(const std::string& name, Scene* scene)
     : name(name), scene_(scene) {}
 
+GameObject::~GameObject() {
+  // the body first, so colliders do not destroy its fixtures one by one
+  rigid_body_2d.reset();
+}
+
 void GameObject::PhysicsUpdate() {
   if (rigid_body_2d) {
     rigid_body_2d->PhysicsUpdate();
@@ -38,15 +46,121 @@ void GameObject::Update() {
     }
   }
 }
+void GameObject::OnCollisionEnter(const Collision2D& collision) {
+  if (rigid_body_2d) {
+    rigid_body_2d->OnCollisionEnter(collision);
+  }
+
+  for (auto it : components_) {
+    if (it->is_enabled) {
+      it->OnCollisionEnter(collision);
+    }
+  }
+}
+
+void GameObject::OnCollisionExit(const Collision2D& collision) {
+  if (rigid_body_2d) {
+    rigid_body_2d->OnCollisionExit(collision);
+  }
+
+  for (auto it : components_) {
+    if (it->is_enabled) {
+      it->OnCollisionExit(collision);
+    }
+  }
+}
+
+// Writes the state of the component as a record of its key and size, so
+// that LoadState can tell which component it belongs to and skip it.
+static void SaveRecord(SnapshotWriter& writer, uint32_t key,
+                       const Component& component) {
+  writer.Write(key);
+  size_t sizeOffset = writer.Size();
+  writer.Write(uint32_t(0));
+  component.SaveState(writer);
+  writer.WriteAt(sizeOffset,
+                 uint32_t(writer.Size() - sizeOffset - sizeof(uint32_t)));
+}
+
+void GameObject::SaveState(SnapshotWriter& writer) const {
+  size_t countOffset = writer.Size();
+  uint32_t count = 0;
+  writer.Write(count);
+  if (rigid_body_2d) {
+    SaveRecord(writer, kRigidBodyKey, *rigid_body_2d);
+    ++count;
+  }
+
+  if (transform) {
+    SaveRecord(writer, kTransformKey, *transform);
+    ++count;
+  }
+
+  for (const auto& [key, component] : ordered_components_) {
+    SaveRecord(writer, key, *component);
+    ++count;
+  }
+  writer.WriteAt(countOffset, count);
+}
+
+void GameObject::LoadState(SnapshotReader& reader) {
+  uint32_t count = 0;
+  reader.Read(count);
+  // records and components are both in key order, so finding each is a merge
+  auto next = ordered_components_.begin();
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t key = 0;
+    uint32_t size = 0;
+    if (!reader.Read(key) || !reader.Read(size)) {
+      break;
+    }
+    SnapshotReader record = reader.Take(size);
+    Component* component = nullptr;
+    if (key == kRigidBodyKey) {
+      component = rigid_body_2d.get();
+    } else if (key == kTransformKey) {
+      component = transform.get();
+    } else {
+      next = std::lower_bound(
+          next, ordered_components_.end(), key,
+          [](const auto& entry, uint32_t key) { return entry.first < key; });
+      if (next != ordered_components_.end() && next->first == key) {
+        component = next->second;
+      }
+    }
+    // components added since the snapshot keep their state, and those
+    // removed since are skipped
+    if (component != nullptr) {
+      component->LoadState(record);
+    }
+  }
+}
+
 void GameObject::RemoveComponent(Component* component) {
+  if (component == rigid_body_2d.get()) {
+    rigid_body_2d.reset();
+    return;
+  }
+
   auto it = std::find_if(components_.begin(), components_.end(),
                          [component](std::shared_ptr<Component> const& i) {
                            return i.get() == component;
                          });
 
   if (it != components_.end()) {
+    std::erase_if(ordered_components_, [component](const auto& entry) {
+      return entry.second == component;
+    });
     components_.erase(it);
   }
 }
 
-Scene* GameObject::GetScene() { return scene_; }
\ No newline at end of file
+Scene* GameObject::GetScene() { return scene_; }
+
+void GameObject::SetStatic(bool isStatic) {
+  if (is_static_ == isStatic) {
+    return;
+  }
+  is_static_ = isStatic;
+  scene_->InvalidateStatic(this);
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "aubengine/input.h"
+
+#include <chrono>
+
+#include "aubengine/input_log.h"
+
+static InputLogWriter recorder_;
+static InputLogReader player_;
+static bool recording_ = false;
+static bool replaying_ = false;
+// the state input was in when recording started, recorded with the first
+// tick
+static std::vector<InputEvent> initial_events_;
+
+void Input::QueueEventImpl(const InputEvent& event) {
+  std::scoped_lock lock(queue_mutex_);
+  queued_.push_back(event);
+}
+
+// Sets or clears the bit of a key or button, recording the change.
+template <size_t N>
+static void ApplyButton(int32_t index, int32_t action, std::bitset<N>& states,
+                        std::bitset<N>& pressed, std::bitset<N>& released) {
+  if (index < 0 || index >= int32_t(N)) {
+    return;
+  }
+  // repeats change nothing
+  if (action == 1) {
+    states[index] = true;
+    pressed[index] = true;
+  } else if (action == 0) {
+    states[index] = false;
+    released[index] = true;
+  }
+}
+
+void Input::ApplyQueuedEvents() {
+  {
+    std::scoped_lock lock(queue_mutex_);
+    events_.swap(queued_);
+    queued_.clear();
+  }
+  if (replaying_) {
+    // live input is ignored for as long as a replay lasts
+    events_.clear();
+    player_.ReadTick(events_);
+  } else if (!initial_events_.empty()) {
+    events_.insert(events_.begin(), initial_events_.begin(),
+                   initial_events_.end());
+    initial_events_.clear();
+  }
+  if (recording_) {
+    recorder_.WriteTick(events_);
+  }
+
+  key_pressed_.reset();
+  key_released_.reset();
+  mouse_pressed_.reset();
+  mouse_released_.reset();
+  gamepad_pressed_.reset();
+  gamepad_released_.reset();
+  scroll_delta_ = {};
+
+  for (const InputEvent& event : events_) {
+    switch (event.type) {
+      case InputEvent::Type::kKey:
+        ApplyButton(event.code, event.action, key_states_, key_pressed_,
+                    key_released_);
+        break;
+      case InputEvent::Type::kMouseButton:
+        ApplyButton(event.code, event.action, mouse_states_, mouse_pressed_,
+                    mouse_released_);
+        break;
+      case InputEvent::Type::kMouseMove:
+        mouse_position_ = {event.x, event.y};
+        break;
+      case InputEvent::Type::kScroll:
+        scroll_delta_ = scroll_delta_ + glm::vec2(event.x, event.y);
+        break;
+      case InputEvent::Type::kGamepadButton:
+        if (event.device >= 0 && event.device < kMaxGamepads &&
+            event.code >= 0 && event.code < kGamepadButtons) {
+          ApplyButton(event.device * kGamepadButtons + event.code,
+                      event.action, gamepad_states_, gamepad_pressed_,
+                      gamepad_released_);
+        }
+        break;
+      case InputEvent::Type::kGamepadAxis:
+        if (event.device >= 0 && event.device < kMaxGamepads &&
+            event.code >= 0 && event.code < kGamepadAxes) {
+          gamepad_axes_[event.device][event.code] = event.x;
+        }
+        break;
+      case InputEvent::Type::kChar:
+        // text input is only read through GetEvents
+        break;
+    }
+  }
+}
+
+std::vector<InputEvent> Input::CurrentStateEvents() const {
+  std::vector<InputEvent> events;
+  auto add = [&events](InputEvent::Type type, int32_t code, float x = 0.0f,
+                       float y = 0.0f, int32_t device = 0) {
+    InputEvent event;
+    event.type = type;
+    event.code = code;
+    event.action = 1;
+    event.device = device;
+    event.x = x;
+    event.y = y;
+    event.time_nanoseconds =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    events.push_back(event);
+  };
+
+  for (size_t key = 0; key < key_states_.size(); ++key) {
+    if (key_states_[key]) {
+      add(InputEvent::Type::kKey, int32_t(key));
+    }
+  }
+  for (int button = 0; button < kMouseButtons; ++button) {
+    if (mouse_states_[button]) {
+      add(InputEvent::Type::kMouseButton, button);
+    }
+  }
+  add(InputEvent::Type::kMouseMove, 0, mouse_position_.x, mouse_position_.y);
+  for (int pad = 0; pad < kMaxGamepads; ++pad) {
+    for (int button = 0; button < kGamepadButtons; ++button) {
+      if (gamepad_states_[pad * kGamepadButtons + button]) {
+        add(InputEvent::Type::kGamepadButton, button, 0.0f, 0.0f, pad);
+      }
+    }
+    for (int axis = 0; axis < kGamepadAxes; ++axis) {
+      if (gamepad_axes_[pad][axis] != 0.0f) {
+        add(InputEvent::Type::kGamepadAxis, axis, gamepad_axes_[pad][axis],
+            0.0f, pad);
+      }
+    }
+  }
+  return events;
+}
+
+void Input::ResetState() {
+  key_states_.reset();
+  mouse_states_.reset();
+  mouse_position_ = {};
+  gamepad_states_.reset();
+  for (auto& axes : gamepad_axes_) {
+    for (float& axis : axes) {
+      axis = 0.0f;
+    }
+  }
+}
+
+bool Input::StartRecording(const std::string& path) {
+  StopRecording();
+  if (!recorder_.Open(path)) {
+    return false;
+  }
+  initial_events_ = instance_->CurrentStateEvents();
+  recording_ = true;
+  return true;
+}
+
+void Input::StopRecording() {
+  if (!recording_) {
+    return;
+  }
+  recorder_.Close();
+  initial_events_.clear();
+  recording_ = false;
+}
+
+bool Input::StartReplay(const std::string& path) {
+  StopReplay();
+  if (!player_.Open(path)) {
+    return false;
+  }
+  // the log starts from cleared state, and brings in what was held itself
+  instance_->ResetState();
+  replaying_ = true;
+  return true;
+}
+
+void Input::StopReplay() { replaying_ = false; }
+
+bool Input::IsReplaying() { return replaying_; }
+
+bool Input::IsReplayFinished() { return replaying_ && player_.IsFinished(); }
@@ -2,25 +2,85 @@
 
 #include <GLFW/glfw3.h>
 
-#include "aubengine/application.h"
+#include <chrono>
 
 Input* Input::instance_ = new InputGLFW();
 
-bool InputGLFW::GetKeyDownImpl(int key) const {
-  return (key_states_[key] && !old_key_states_[key]);
+// gamepads as of the last PollGamepads, and whether they were connected
+static GLFWgamepadstate gamepads_[Input::kMaxGamepads]{};
+static bool gamepads_connected_[Input::kMaxGamepads]{};
+
+static uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static void Queue(InputEvent::Type type, int32_t code, int32_t action,
+                  float x = 0.0f, float y = 0.0f, int32_t device = 0) {
+  InputEvent event;
+  event.type = type;
+  event.code = code;
+  event.action = action;
+  event.device = device;
+  event.x = x;
+  event.y = y;
+  event.time_nanoseconds = Now();
+  Input::QueueEvent(event);
 }
+
+bool InputGLFW::GetKeyDownImpl(int key) const { return key_pressed_[key]; }
 bool InputGLFW::GetKeyImpl(int key) const { return key_states_[key]; }
-bool InputGLFW::GetKeyUpImpl(int key) const {
-  return (!key_states_[key] && old_key_states_[key]);
+bool InputGLFW::GetKeyUpImpl(int key) const { return key_released_[key]; }
+
+void InputGLFW::PollInputImpl() { ApplyQueuedEvents(); }
+
+void InputGLFW::Attach(GLFWwindow* window) {
+  // GLFW releases every key and button itself when a window loses focus, so
+  // nothing stays stuck down
+  glfwSetKeyCallback(window, [](GLFWwindow*, int key, int, int action, int) {
+    Queue(InputEvent::Type::kKey, key, action);
+  });
+  glfwSetCharCallback(window, [](GLFWwindow*, unsigned int codepoint) {
+    Queue(InputEvent::Type::kChar, int32_t(codepoint), 1);
+  });
+  glfwSetMouseButtonCallback(window,
+                             [](GLFWwindow*, int button, int action, int) {
+                               Queue(InputEvent::Type::kMouseButton, button,
+                                     action);
+                             });
+  glfwSetCursorPosCallback(window, [](GLFWwindow*, double x, double y) {
+    Queue(InputEvent::Type::kMouseMove, 0, 0, float(x), float(y));
+  });
+  glfwSetScrollCallback(window, [](GLFWwindow*, double x, double y) {
+    Queue(InputEvent::Type::kScroll, 0, 0, float(x), float(y));
+  });
 }
-void InputGLFW::PollInputImpl() {
-  for (int i = 0; i <= GLFW_KEY_LAST; ++i) {
-    old_key_states_[i] = key_states_[i];
-  }
 
-  GLFWwindow* window = static_cast<GLFWwindow*>(
-      Aubengine::Application::GetInstance().focused_window->GetWindowNative());
-  for (int i = 0; i <= GLFW_KEY_LAST; ++i) {
-    key_states_[i] = (glfwGetKey(window, i));
+void InputGLFW::PollGamepads() {
+  for (int pad = 0; pad < kMaxGamepads; ++pad) {
+    GLFWgamepadstate state{};
+    bool connected = glfwJoystickIsGamepad(GLFW_JOYSTICK_1 + pad) &&
+                     glfwGetGamepadState(GLFW_JOYSTICK_1 + pad, &state);
+    if (!connected && !gamepads_connected_[pad]) {
+      continue;
+    }
+
+    // a pad going away reads as everything released and centered
+    GLFWgamepadstate& last = gamepads_[pad];
+    for (int button = 0; button < kGamepadButtons; ++button) {
+      if (state.buttons[button] != last.buttons[button]) {
+        Queue(InputEvent::Type::kGamepadButton, button,
+              state.buttons[button] == GLFW_PRESS ? 1 : 0, 0.0f, 0.0f, pad);
+      }
+    }
+    for (int axis = 0; axis < kGamepadAxes; ++axis) {
+      if (state.axes[axis] != last.axes[axis]) {
+        Queue(InputEvent::Type::kGamepadAxis, axis, 0, state.axes[axis], 0.0f,
+              pad);
+      }
+    }
+    last = state;
+    gamepads_connected_[pad] = connected;
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,212 @@
+#include "aubengine/input_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+
+static constexpr char kMagic[4] = {'A', 'U', 'B', 'I'};
+static constexpr uint8_t kVersion = 1;
+// buffered bytes written out at once
+static constexpr size_t kFlushBytes = 64 * 1024;
+
+static uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static void WriteVarint(std::vector<uint8_t>& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(uint8_t(value) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(uint8_t(value));
+}
+
+static bool ReadVarint(const std::vector<uint8_t>& in, size_t& offset,
+                       uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && offset < in.size(); shift += 7) {
+    uint8_t byte = in[offset++];
+    value |= uint64_t(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// codes are small and may be negative (unknown keys), so they are zigzagged
+static uint64_t ZigZag(int32_t value) {
+  // in 32 bits throughout, so -1 is 1 rather than a 64-bit pattern
+  return uint64_t(uint32_t(value) << 1) ^ uint64_t(uint32_t(value >> 31));
+}
+
+static int32_t UnZigZag(uint64_t value) {
+  return int32_t(uint32_t(value >> 1) ^ -uint32_t(value & 1));
+}
+
+static void WriteFloat(std::vector<uint8_t>& out, float value) {
+  uint8_t bytes[sizeof(float)];
+  std::memcpy(bytes, &value, sizeof(float));
+  out.insert(out.end(), std::begin(bytes), std::end(bytes));
+}
+
+static bool ReadFloat(const std::vector<uint8_t>& in, size_t& offset,
+                      float& value) {
+  if (offset + sizeof(float) > in.size()) {
+    return false;
+  }
+  std::memcpy(&value, in.data() + offset, sizeof(float));
+  offset += sizeof(float);
+  return true;
+}
+
+// only these carry values besides their code and action
+static bool HasX(InputEvent::Type type) {
+  return type == InputEvent::Type::kMouseMove ||
+         type == InputEvent::Type::kScroll ||
+         type == InputEvent::Type::kGamepadAxis;
+}
+
+static bool HasY(InputEvent::Type type) {
+  return type == InputEvent::Type::kMouseMove ||
+         type == InputEvent::Type::kScroll;
+}
+
+bool InputLogWriter::Open(const std::string& path) {
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_) {
+    return false;
+  }
+  buffer_.assign(std::begin(kMagic), std::end(kMagic));
+  buffer_.push_back(kVersion);
+  tick_ = 0;
+  last_record_tick_ = 0;
+  last_time_ = Now();
+  return true;
+}
+
+void InputLogWriter::WriteTick(const std::vector<InputEvent>& events) {
+  if (!file_.is_open()) {
+    return;
+  }
+  if (!events.empty()) {
+    WriteVarint(buffer_, tick_ - last_record_tick_);
+    WriteVarint(buffer_, events.size());
+    for (const InputEvent& event : events) {
+      buffer_.push_back(uint8_t(event.type));
+      WriteVarint(buffer_, ZigZag(event.code));
+      buffer_.push_back(uint8_t(event.action));
+      buffer_.push_back(uint8_t(event.device));
+      // events are queued in time order, but clocks of other sources may
+      // not agree, so time never goes backwards in the log
+      uint64_t time = std::max(event.time_nanoseconds, last_time_);
+      WriteVarint(buffer_, time - last_time_);
+      last_time_ = time;
+      if (HasX(event.type)) {
+        WriteFloat(buffer_, event.x);
+      }
+      if (HasY(event.type)) {
+        WriteFloat(buffer_, event.y);
+      }
+    }
+    last_record_tick_ = tick_;
+    if (buffer_.size() >= kFlushBytes) {
+      Flush();
+    }
+  }
+  ++tick_;
+}
+
+void InputLogWriter::Close() {
+  if (!file_.is_open()) {
+    return;
+  }
+  WriteVarint(buffer_, tick_ - last_record_tick_);
+  WriteVarint(buffer_, 0);
+  Flush();
+  file_.close();
+}
+
+void InputLogWriter::Flush() {
+  file_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+  buffer_.clear();
+}
+
+bool InputLogReader::Open(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  data_.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  if (data_.size() < sizeof(kMagic) + 1 ||
+      std::memcmp(data_.data(), kMagic, sizeof(kMagic)) != 0 ||
+      data_[sizeof(kMagic)] != kVersion) {
+    data_.clear();
+    return false;
+  }
+
+  offset_ = sizeof(kMagic) + 1;
+  tick_ = 0;
+  next_record_tick_ = 0;
+  last_time_ = Now();
+  finished_ = false;
+  return ReadRecordHeader();
+}
+
+bool InputLogReader::ReadRecordHeader() {
+  uint64_t ticks = 0;
+  if (!ReadVarint(data_, offset_, ticks) ||
+      !ReadVarint(data_, offset_, next_record_events_)) {
+    // a log cut short, as by a crash, ends where it was cut
+    finished_ = true;
+    return false;
+  }
+  next_record_tick_ += ticks;
+  return true;
+}
+
+void InputLogReader::ReadTick(std::vector<InputEvent>& events) {
+  if (finished_) {
+    return;
+  }
+  if (tick_++ != next_record_tick_) {
+    return;
+  }
+  if (next_record_events_ == 0) {
+    finished_ = true;
+    return;
+  }
+
+  for (uint64_t i = 0; i < next_record_events_; ++i) {
+    if (offset_ + 1 > data_.size()) {
+      finished_ = true;
+      return;
+    }
+    InputEvent event;
+    uint64_t code = 0;
+    uint64_t elapsed = 0;
+    event.type = InputEvent::Type(data_[offset_++]);
+    bool complete = ReadVarint(data_, offset_, code) &&
+                    offset_ + 2 <= data_.size();
+    if (complete) {
+      event.code = UnZigZag(code);
+      event.action = data_[offset_++];
+      event.device = data_[offset_++];
+      complete = ReadVarint(data_, offset_, elapsed) &&
+                 (!HasX(event.type) || ReadFloat(data_, offset_, event.x)) &&
+                 (!HasY(event.type) || ReadFloat(data_, offset_, event.y));
+    }
+    if (!complete) {
+      finished_ = true;
+      return;
+    }
+    last_time_ += elapsed;
+    event.time_nanoseconds = last_time_;
+    events.push_back(event);
+  }
+  ReadRecordHeader();
+}
@@ -0,0 +1,111 @@
+#include "aubengine/metrics.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+
+static std::mutex metrics_mutex_;
+// ordered, so dumps list metrics in a stable order
+static std::map<std::string, std::unique_ptr<MetricCounter>> counters_;
+static std::map<std::string, std::unique_ptr<MetricGauge>> gauges_;
+static std::map<std::string, std::unique_ptr<MetricHistogram>> histograms_;
+
+template <typename T>
+static T& GetOrCreate(std::map<std::string, std::unique_ptr<T>>& metrics,
+                      const std::string& name) {
+  std::scoped_lock lock(metrics_mutex_);
+  auto& metric = metrics[name];
+  if (!metric) {
+    metric = std::make_unique<T>();
+  }
+  return *metric;
+}
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+  size_t index = size_t(p * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void MetricHistogram::Observe(double value) {
+  std::scoped_lock lock(mutex_);
+  if (samples_.size() < kWindow) {
+    samples_.push_back(value);
+  } else {
+    samples_[next_] = value;
+  }
+  next_ = (next_ + 1) % kWindow;
+}
+
+HistogramSummary MetricHistogram::Summarize() const {
+  std::vector<double> sorted;
+  {
+    std::scoped_lock lock(mutex_);
+    sorted = samples_;
+  }
+
+  HistogramSummary summary;
+  if (sorted.empty()) {
+    return summary;
+  }
+
+  std::sort(sorted.begin(), sorted.end());
+  summary.count = sorted.size();
+  double sum = 0;
+  for (double sample : sorted) {
+    sum += sample;
+  }
+  summary.mean = sum / sorted.size();
+  summary.min = sorted.front();
+  summary.max = sorted.back();
+  summary.p50 = Percentile(sorted, 0.50);
+  summary.p99 = Percentile(sorted, 0.99);
+  return summary;
+}
+
+MetricCounter& Metrics::GetCounter(const std::string& name) {
+  return GetOrCreate(counters_, name);
+}
+
+MetricGauge& Metrics::GetGauge(const std::string& name) {
+  return GetOrCreate(gauges_, name);
+}
+
+MetricHistogram& Metrics::GetHistogram(const std::string& name) {
+  return GetOrCreate(histograms_, name);
+}
+
+void Metrics::EndFrame() {
+  std::scoped_lock lock(metrics_mutex_);
+  for (const auto& iter : counters_) {
+    MetricCounter& counter = *iter.second;
+    // an Add racing with the exchange lands in the next frame, not lost
+    uint64_t frame = counter.frame_.exchange(0, std::memory_order_relaxed);
+    counter.last_frame_ = frame;
+    counter.total_ += frame;
+  }
+}
+
+bool Metrics::DumpCsv(const std::string& path) {
+  std::ofstream out(path);
+  if (!out) {
+    return false;
+  }
+
+  std::scoped_lock lock(metrics_mutex_);
+  out << "name,type,value,total,count,mean,min,max,p50,p99\n";
+  for (const auto& [name, counter] : counters_) {
+    out << name << ",counter," << counter->LastFrame() << ","
+        << counter->Total() << ",,,,,,\n";
+  }
+  for (const auto& [name, gauge] : gauges_) {
+    out << name << ",gauge," << gauge->Get() << ",,,,,,,\n";
+  }
+  for (const auto& [name, histogram] : histograms_) {
+    HistogramSummary summary = histogram->Summarize();
+    out << name << ",histogram,,," << summary.count << "," << summary.mean
+        << "," << summary.min << "," << summary.max << "," << summary.p50
+        << "," << summary.p99 << "\n";
+  }
+  return bool(out);
+}
@@ -0,0 +1,481 @@
+#include "aubengine/physics_world.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "aubengine/metrics.h"
+#include "aubengine/profiler.h"
+
+PhysicsWorld::PhysicsWorld(const b2Vec2& gravity) : world_(gravity) {
+  recorded_.reserve(kContactCapacity);
+  contacts_.reserve(kContactCapacity);
+  world_.SetContactListener(this);
+}
+
+PhysicsWorld::~PhysicsWorld() {
+  {
+    std::scoped_lock lock(step_mutex_);
+    stopping_ = true;
+  }
+  step_condition_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+b2Body* PhysicsWorld::CreateBody(const b2BodyDef& bodyDef,
+                                 RigidBody2D* owner) {
+  EndStep();
+
+  std::scoped_lock lock(world_mutex_);
+  return CreateBodyLocked(bodyDef, owner);
+}
+
+std::vector<b2Body*> PhysicsWorld::CreateBodies(
+    std::span<const b2BodyDef> bodyDefs) {
+  EndStep();
+
+  std::scoped_lock lock(world_mutex_);
+  Reserve(bodies_.size() + bodyDefs.size());
+  std::vector<b2Body*> bodies;
+  bodies.reserve(bodyDefs.size());
+  for (const b2BodyDef& bodyDef : bodyDefs) {
+    bodies.push_back(CreateBodyLocked(bodyDef, nullptr));
+  }
+  return bodies;
+}
+
+b2Body* PhysicsWorld::CreateBodyLocked(const b2BodyDef& bodyDef,
+                                       RigidBody2D* owner) {
+  b2BodyDef def = bodyDef;
+  def.userData.pointer = bodies_.size();
+  // fixtures attached before the next step get no proxies until then
+  def.enabled = false;
+  b2Body* body = world_.CreateBody(&def);
+  if (bodyDef.enabled) {
+    pending_enable_.push_back(body);
+  }
+
+  // until the next step, the pose is the one the body was created with
+  PhysicsBodyState state;
+  state.position = def.position;
+  state.angle = def.angle;
+  state.revision = steps_;
+  bodies_.push_back(body);
+  owners_.push_back(owner);
+  was_awake_.push_back(def.awake);
+  states_.push_back(state);
+  return body;
+}
+
+void PhysicsWorld::DestroyBody(b2Body* body) { DestroyBodies({&body, 1}); }
+
+void PhysicsWorld::DestroyBodies(std::span<b2Body* const> bodies) {
+  // indices are about to move, so no change may still refer to them
+  EndStep();
+
+  // sorted, so each purge below is one pass over what it purges
+  std::vector<b2Body*> doomed(bodies.begin(), bodies.end());
+  std::sort(doomed.begin(), doomed.end());
+  auto isDoomed = [&doomed](b2Body* body) {
+    return std::binary_search(doomed.begin(), doomed.end(), body);
+  };
+  {
+    // commands queued for the bodies must not reach the worker
+    std::scoped_lock lock(commands_mutex_);
+    std::erase_if(commands_, [&isDoomed](const PhysicsCommand& command) {
+      return isDoomed(command.body);
+    });
+  }
+  // Contacts are cleared rather than erased, as they may be being dispatched
+  // by the very handler destroying the body.
+  for (auto& contact : contacts_) {
+    if (isDoomed(contact.body_a) || isDoomed(contact.body_b)) {
+      contact.body_a = nullptr;
+      contact.body_b = nullptr;
+    }
+  }
+
+  std::scoped_lock lock(world_mutex_);
+  std::erase_if(pending_enable_, isDoomed);
+  // the contacts Box2D ends along with the bodies are not reported
+  world_.SetContactListener(nullptr);
+  for (b2Body* body : bodies) {
+    // the last body takes the freed index
+    size_t index = body->GetUserData().pointer;
+    size_t last = bodies_.size() - 1;
+    if (index != last) {
+      bodies_[index] = bodies_[last];
+      owners_[index] = owners_[last];
+      was_awake_[index] = was_awake_[last];
+      states_[index] = states_[last];
+      bodies_[index]->GetUserData().pointer = index;
+    }
+    bodies_.pop_back();
+    owners_.pop_back();
+    was_awake_.pop_back();
+    states_.pop_back();
+    world_.DestroyBody(body);
+  }
+  world_.SetContactListener(this);
+}
+
+void PhysicsWorld::Reserve(size_t bodies) {
+  bodies_.reserve(bodies);
+  owners_.reserve(bodies);
+  was_awake_.reserve(bodies);
+  states_.reserve(bodies);
+}
+
+void PhysicsWorld::SetEnabled(b2Body* body, bool enabled) {
+  EndStep();
+
+  std::scoped_lock lock(world_mutex_);
+  auto pending =
+      std::find(pending_enable_.begin(), pending_enable_.end(), body);
+  if (enabled) {
+    if (!body->IsEnabled() && pending == pending_enable_.end()) {
+      pending_enable_.push_back(body);
+    }
+  } else if (pending != pending_enable_.end()) {
+    pending_enable_.erase(pending);
+  } else {
+    // the contacts this ends are reported, as the body lives on
+    body->SetEnabled(false);
+  }
+}
+
+b2Fixture* PhysicsWorld::CreateFixture(b2Body* body,
+                                       const b2FixtureDef& fixtureDef) {
+  EndStep();
+
+  std::scoped_lock lock(world_mutex_);
+  return body->CreateFixture(&fixtureDef);
+}
+
+void PhysicsWorld::DestroyFixture(b2Body* body, b2Fixture* fixture) {
+  EndStep();
+
+  std::scoped_lock lock(world_mutex_);
+  body->DestroyFixture(fixture);
+}
+
+void PhysicsWorld::SetGravity(const b2Vec2& gravity) {
+  std::scoped_lock lock(world_mutex_);
+  world_.SetGravity(gravity);
+}
+
+void PhysicsWorld::Enqueue(const PhysicsCommand& command) {
+  std::scoped_lock lock(commands_mutex_);
+  commands_.push_back(command);
+}
+
+void PhysicsWorld::Enqueue(const std::vector<PhysicsCommand>& commands) {
+  std::scoped_lock lock(commands_mutex_);
+  commands_.insert(commands_.end(), commands.begin(), commands.end());
+}
+
+void PhysicsWorld::SetStepRate(uint32_t hz) {
+  std::scoped_lock lock(step_mutex_);
+  step_rate_ = hz;
+  accumulator_ = 0.0f;
+}
+
+void PhysicsWorld::SetIterations(int32_t velocityIterations,
+                                 int32_t positionIterations) {
+  std::scoped_lock lock(step_mutex_);
+  velocity_iterations_ = velocityIterations;
+  position_iterations_ = positionIterations;
+}
+
+void PhysicsWorld::SetDeterministic(bool deterministic) {
+  std::scoped_lock lock(step_mutex_);
+  deterministic_ = deterministic;
+  accumulator_ = 0.0f;
+}
+
+void PhysicsWorld::BeginStep(float elapsed) {
+  EndStep();
+  // scenes without bodies never wake a physics thread
+  if (bodies_.empty()) {
+    return;
+  }
+
+  {
+    std::scoped_lock lock(step_mutex_);
+    if (deterministic_) {
+      uint32_t rate = step_rate_ != 0 ? step_rate_ : kDeterministicStepRate;
+      time_step_ = 1.0f / rate;
+      substeps_ = 1;
+    } else if (step_rate_ == 0) {
+      time_step_ = elapsed;
+      substeps_ = 1;
+    } else {
+      time_step_ = 1.0f / step_rate_;
+      accumulator_ += elapsed;
+      substeps_ = uint32_t(accumulator_ / time_step_);
+      accumulator_ -= substeps_ * time_step_;
+      if (substeps_ > kMaxSubsteps) {
+        substeps_ = kMaxSubsteps;
+      }
+    }
+    if (substeps_ == 0) {
+      // commands stay queued for the tick that steps
+      return;
+    }
+    step_requested_ = true;
+    step_in_flight_ = true;
+  }
+  if (!worker_.joinable()) {
+    worker_ = std::thread(&PhysicsWorld::Run, this);
+  }
+  step_condition_.notify_all();
+}
+
+void PhysicsWorld::EndStep() {
+  std::unique_lock lock(step_mutex_);
+  if (!step_in_flight_) {
+    return;
+  }
+  step_condition_.wait(lock, [this]() { return !step_in_flight_; });
+  for (const auto& [index, state] : changes_) {
+    states_[index] = state;
+  }
+  changes_.clear();
+  // both buffers keep their capacity, so recording settles into reuse
+  std::swap(recorded_, contacts_);
+  recorded_.clear();
+
+  static MetricCounter& contacts = Metrics::GetCounter("physics.contacts");
+  contacts.Add(contacts_.size());
+}
+
+const PhysicsBodyState& PhysicsWorld::GetState(b2Body* body) const {
+  return states_[body->GetUserData().pointer];
+}
+
+// fixed-point value of v, on the deterministic grid
+static int64_t ToFixed(float v) {
+  return std::llround(double(v) * PhysicsWorld::kDeterministicScale);
+}
+
+static float Snap(float v) {
+  return float(ToFixed(v) / double(PhysicsWorld::kDeterministicScale));
+}
+
+uint64_t PhysicsWorld::Checksum() const {
+  // FNV-1a over the fixed-point poses, in body order
+  uint64_t hash = 14695981039346656037ull;
+  auto mix = [&hash](int64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      hash ^= uint64_t(value >> (i * 8)) & 0xff;
+      hash *= 1099511628211ull;
+    }
+  };
+  for (const PhysicsBodyState& state : states_) {
+    mix(ToFixed(state.position.x));
+    mix(ToFixed(state.position.y));
+    mix(ToFixed(state.angle));
+  }
+  return hash;
+}
+
+PhysicsBodySnapshot PhysicsWorld::SaveBody(b2Body* body) {
+  EndStep();
+
+  std::scoped_lock lock(world_mutex_);
+  PhysicsBodySnapshot snapshot;
+  snapshot.position = body->GetPosition();
+  snapshot.angle = body->GetAngle();
+  snapshot.linear_velocity = body->GetLinearVelocity();
+  snapshot.angular_velocity = body->GetAngularVelocity();
+  snapshot.awake = body->IsAwake();
+  return snapshot;
+}
+
+uint64_t PhysicsWorld::RestoreBody(b2Body* body,
+                                   const PhysicsBodySnapshot& snapshot) {
+  EndStep();
+
+  std::scoped_lock lock(world_mutex_);
+  body->SetTransform(snapshot.position, snapshot.angle);
+  body->SetLinearVelocity(snapshot.linear_velocity);
+  body->SetAngularVelocity(snapshot.angular_velocity);
+  body->SetAwake(snapshot.awake != 0);
+
+  // a revision no reader has seen, so the pose counts as new
+  size_t index = body->GetUserData().pointer;
+  PhysicsBodyState& state = states_[index];
+  state.position = snapshot.position;
+  state.angle = snapshot.angle;
+  state.revision = ++steps_;
+  was_awake_[index] = snapshot.awake != 0;
+  return state.revision;
+}
+
+void PhysicsWorld::DiscardPending() {
+  EndStep();
+  {
+    std::scoped_lock lock(commands_mutex_);
+    commands_.clear();
+  }
+  contacts_.clear();
+}
+
+RigidBody2D* PhysicsWorld::GetOwner(b2Body* body) const {
+  return owners_[body->GetUserData().pointer];
+}
+
+void PhysicsWorld::SetOwner(b2Body* body, RigidBody2D* owner) {
+  owners_[body->GetUserData().pointer] = owner;
+}
+
+void PhysicsWorld::Run() {
+  static MetricHistogram& stepTime = Metrics::GetHistogram("physics.step_ms");
+  static MetricGauge& bodiesAwake = Metrics::GetGauge("physics.bodies_awake");
+
+  while (true) {
+    float timeStep;
+    uint32_t substeps;
+    int32_t velocityIterations;
+    int32_t positionIterations;
+    bool deterministic;
+    {
+      std::unique_lock lock(step_mutex_);
+      step_condition_.wait(lock,
+                           [this]() { return step_requested_ || stopping_; });
+      if (stopping_) {
+        return;
+      }
+      step_requested_ = false;
+      timeStep = time_step_;
+      substeps = substeps_;
+      velocityIterations = velocity_iterations_;
+      positionIterations = position_iterations_;
+      deterministic = deterministic_;
+    }
+
+    {
+      std::scoped_lock lock(world_mutex_);
+      {
+        std::scoped_lock commandsLock(commands_mutex_);
+        std::swap(commands_, applying_);
+      }
+      if (deterministic) {
+        // objects are visited in an order that differs between machines,
+        // bodies are not; the sort is stable, so each body's own commands
+        // keep their order
+        std::stable_sort(applying_.begin(), applying_.end(),
+                         [](const PhysicsCommand& a, const PhysicsCommand& b) {
+                           return a.body->GetUserData().pointer <
+                                  b.body->GetUserData().pointer;
+                         });
+      }
+      ApplyCommands(applying_);
+      // proxies are created at the poses the commands just set
+      for (b2Body* body : pending_enable_) {
+        body->SetEnabled(true);
+      }
+      pending_enable_.clear();
+
+      AUBENGINE_PROFILE_SCOPE("b2World::Step");
+      auto start = std::chrono::steady_clock::now();
+      for (uint32_t i = 0; i < substeps; ++i) {
+        world_.Step(timeStep, velocityIterations, positionIterations);
+        if (deterministic) {
+          Quantize();
+        }
+      }
+      stepTime.Observe(std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count());
+
+      // Box2D keeps no list of awake bodies, so finding them is a pass over
+      // flags, but only they get their pose read and published.
+      ++steps_;
+      uint32_t awake = 0;
+      for (size_t i = 0; i < bodies_.size(); ++i) {
+        const b2Body* body = bodies_[i];
+        bool isAwake = body->IsAwake();
+        if (isAwake || was_awake_[i]) {
+          PhysicsBodyState state;
+          state.position = body->GetPosition();
+          state.angle = body->GetAngle();
+          state.revision = steps_;
+          changes_.emplace_back(uint32_t(i), state);
+        }
+        was_awake_[i] = isAwake;
+        awake += isAwake;
+      }
+      awake_bodies_ = awake;
+      bodiesAwake.Set(awake);
+    }
+
+    {
+      std::scoped_lock lock(step_mutex_);
+      step_in_flight_ = false;
+    }
+    step_condition_.notify_all();
+  }
+}
+
+void PhysicsWorld::Quantize() {
+  for (size_t i = 0; i < bodies_.size(); ++i) {
+    // bodies at rest were snapped in the step they fell asleep in
+    b2Body* body = bodies_[i];
+    if ((!body->IsAwake() && !was_awake_[i]) ||
+        body->GetType() == b2_staticBody) {
+      continue;
+    }
+    b2Vec2 position = body->GetPosition();
+    body->SetTransform({Snap(position.x), Snap(position.y)},
+                       Snap(body->GetAngle()));
+    b2Vec2 velocity = body->GetLinearVelocity();
+    body->SetLinearVelocity({Snap(velocity.x), Snap(velocity.y)});
+    body->SetAngularVelocity(Snap(body->GetAngularVelocity()));
+  }
+}
+
+void PhysicsWorld::ApplyCommands(std::vector<PhysicsCommand>& commands) {
+  for (const auto& command : commands) {
+    b2Body* body = command.body;
+    switch (command.type) {
+      case PhysicsCommand::Type::kSetTransform:
+        body->SetTransform(command.vector, command.angle);
+        break;
+      case PhysicsCommand::Type::kSetLinearVelocity:
+        body->SetLinearVelocity(command.vector);
+        break;
+      case PhysicsCommand::Type::kApplyForce:
+        body->ApplyForceToCenter(command.vector, true);
+        break;
+      case PhysicsCommand::Type::kApplyLinearImpulse:
+        body->ApplyLinearImpulseToCenter(command.vector, true);
+        break;
+      case PhysicsCommand::Type::kSetAwake:
+        body->SetAwake(command.flag);
+        break;
+    }
+  }
+  commands.clear();
+}
+
+void PhysicsWorld::BeginContact(b2Contact* contact) {
+  RecordContact(contact, true);
+}
+
+void PhysicsWorld::EndContact(b2Contact* contact) {
+  RecordContact(contact, false);
+}
+
+void PhysicsWorld::RecordContact(b2Contact* contact, bool begin) {
+  b2Fixture* fixtureA = contact->GetFixtureA();
+  b2Fixture* fixtureB = contact->GetFixtureB();
+  PhysicsContact recorded;
+  recorded.body_a = fixtureA->GetBody();
+  recorded.body_b = fixtureB->GetBody();
+  recorded.begin = begin;
+  recorded.is_trigger = fixtureA->IsSensor() || fixtureB->IsSensor();
+  recorded_.push_back(recorded);
+}
@@ -0,0 +1,221 @@
+#include "aubengine/profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace {
+struct ThreadEvent {
+  ProfileEvent event;
+  bool gpu = false;
+};
+
+// Written only by its own thread; the count is published with release so an
+// exporter that reads it with acquire sees every event below it.
+struct ThreadBuffer {
+  uint32_t thread_id = 0;
+  std::unique_ptr<ThreadEvent[]> events;
+  std::atomic<uint64_t> written = 0;
+};
+}  // namespace
+
+std::atomic<bool> Profiler::enabled_ = false;
+
+// Buffers are owned by the registry rather than by their threads, so the
+// zones of a thread that has exited can still be exported.
+static std::mutex buffers_mutex_;
+static std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+static const auto epoch_ = std::chrono::steady_clock::now();
+
+static ThreadBuffer& GetThreadBuffer() {
+  // registering takes the lock once per thread, recording never does
+  thread_local ThreadBuffer* buffer = nullptr;
+  if (buffer == nullptr) {
+    auto created = std::make_shared<ThreadBuffer>();
+    created->events =
+        std::make_unique<ThreadEvent[]>(Profiler::kEventsPerThread);
+    std::scoped_lock lock(buffers_mutex_);
+    created->thread_id = uint32_t(buffers_.size()) + 1;
+    buffers_.push_back(created);
+    buffer = created.get();
+  }
+  return *buffer;
+}
+
+static void Append(const ThreadEvent& event) {
+  ThreadBuffer& buffer = GetThreadBuffer();
+  uint64_t index = buffer.written.load(std::memory_order_relaxed);
+  buffer.events[index % Profiler::kEventsPerThread] = event;
+  buffer.written.store(index + 1, std::memory_order_release);
+}
+
+static void WriteName(std::ofstream& out, const char* name) {
+  out << '"';
+  for (const char* c = name; *c; ++c) {
+    if (*c == '"' || *c == '\\') {
+      out << '\\';
+    }
+    out << *c;
+  }
+  out << '"';
+}
+
+void Profiler::SetEnabled(bool enabled) { enabled_ = enabled; }
+
+uint64_t Profiler::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - epoch_)
+      .count();
+}
+
+void Profiler::Record(const char* name, uint64_t start, uint64_t end) {
+  Append({{name, start, end}, false});
+}
+
+void Profiler::RecordGpu(const char* name, uint64_t start, uint64_t end) {
+  Append({{name, start, end}, true});
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) {
+  std::ofstream out(path);
+  if (!out) {
+    return false;
+  }
+
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::scoped_lock lock(buffers_mutex_);
+    buffers = buffers_;
+  }
+
+  // Each thread gets a CPU track and, if it measured any, a GPU track; the
+  // GPU track ids are offset so they never collide with thread ids.
+  constexpr uint32_t kGpuTrackOffset = 1000000;
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto& buffer : buffers) {
+    uint64_t written = buffer->written.load(std::memory_order_acquire);
+    uint64_t begin =
+        written > kEventsPerThread ? written - kEventsPerThread : 0;
+    bool hasGpu = false;
+    for (uint64_t i = begin; i < written; ++i) {
+      const ThreadEvent& event = buffer->events[i % kEventsPerThread];
+      hasGpu |= event.gpu;
+      out << (first ? "\n" : ",\n") << "{\"name\":";
+      first = false;
+      WriteName(out, event.event.name);
+      out << ",\"ph\":\"X\",\"pid\":1,\"tid\":"
+          << buffer->thread_id + (event.gpu ? kGpuTrackOffset : 0)
+          << ",\"ts\":" << event.event.start_nanoseconds / 1000.0
+          << ",\"dur\":"
+          << (event.event.end_nanoseconds - event.event.start_nanoseconds) /
+                 1000.0
+          << "}";
+    }
+
+    out << (first ? "\n" : ",\n")
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << buffer->thread_id << ",\"args\":{\"name\":\"Thread "
+        << buffer->thread_id << "\"}}";
+    first = false;
+    if (hasGpu) {
+      out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+          << buffer->thread_id + kGpuTrackOffset
+          << ",\"args\":{\"name\":\"GPU (Thread " << buffer->thread_id
+          << ")\"}}";
+    }
+  }
+  out << "\n]}\n";
+  return bool(out);
+}
+
+void GpuTimer::Initialize(GladGLContext* context) {
+  context_ = context;
+
+  // Timestamps count from an arbitrary GPU epoch; reading the current one
+  // synchronously once lines them up with the CPU zones.
+  GLint64 gpuNow = 0;
+  context_->GetInteger64v(GL_TIMESTAMP, &gpuNow);
+  gpu_offset_ = int64_t(gpuNow) - int64_t(Profiler::Now());
+}
+
+void GpuTimer::Release() {
+  if (context_ == nullptr) {
+    return;
+  }
+
+  for (const auto& pass : pending_) {
+    free_queries_.push_back(pass.begin);
+    free_queries_.push_back(pass.end);
+  }
+  pending_.clear();
+  if (!free_queries_.empty()) {
+    context_->DeleteQueries(GLsizei(free_queries_.size()),
+                            free_queries_.data());
+    free_queries_.clear();
+  }
+  context_ = nullptr;
+}
+
+unsigned int GpuTimer::AcquireQuery() {
+  if (free_queries_.empty()) {
+    unsigned int query = 0;
+    context_->GenQueries(1, &query);
+    return query;
+  }
+
+  unsigned int query = free_queries_.back();
+  free_queries_.pop_back();
+  return query;
+}
+
+void GpuTimer::Begin(const char* name) {
+  current_.name = nullptr;
+  if (context_ == nullptr || !Profiler::IsEnabled()) {
+    return;
+  }
+
+  current_.name = name;
+  current_.begin = AcquireQuery();
+  context_->QueryCounter(current_.begin, GL_TIMESTAMP);
+}
+
+void GpuTimer::End() {
+  if (current_.name == nullptr) {
+    return;
+  }
+
+  current_.end = AcquireQuery();
+  context_->QueryCounter(current_.end, GL_TIMESTAMP);
+  pending_.push_back(current_);
+  current_.name = nullptr;
+}
+
+void GpuTimer::Collect() {
+  if (context_ == nullptr) {
+    return;
+  }
+
+  // passes complete in order, so the first one still in flight ends the scan
+  while (!pending_.empty()) {
+    const Pass& pass = pending_.front();
+    GLint available = 0;
+    context_->GetQueryObjectiv(pass.end, GL_QUERY_RESULT_AVAILABLE,
+                               &available);
+    if (!available) {
+      break;
+    }
+
+    GLuint64 begin = 0;
+    GLuint64 end = 0;
+    context_->GetQueryObjectui64v(pass.begin, GL_QUERY_RESULT, &begin);
+    context_->GetQueryObjectui64v(pass.end, GL_QUERY_RESULT, &end);
+    Profiler::RecordGpu(pass.name, uint64_t(int64_t(begin) - gpu_offset_),
+                        uint64_t(int64_t(end) - gpu_offset_));
+
+    free_queries_.push_back(pass.begin);
+    free_queries_.push_back(pass.end);
+    pending_.pop_front();
+  }
+}
@@ -0,0 +1,73 @@
+#include "aubengine/render_target.h"
+
+#include <iostream>
+
+#include "aubengine/texture_2d.h"
+
+RenderTarget::RenderTarget(GladGLContext* context, uint32_t width,
+                           uint32_t height)
+    : context_(context), width_(width), height_(height) {
+  Create();
+}
+
+RenderTarget::~RenderTarget() { Destroy(); }
+
+void RenderTarget::Begin() {
+  context_->GetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer_);
+  context_->GetIntegerv(GL_VIEWPORT, previous_viewport_);
+  if (!complete_) {
+    return;
+  }
+
+  context_->BindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  context_->Viewport(0, 0, width_, height_);
+  context_->ClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  context_->Clear(GL_COLOR_BUFFER_BIT);
+}
+
+void RenderTarget::End() {
+  context_->BindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer_);
+  context_->Viewport(previous_viewport_[0], previous_viewport_[1],
+                     previous_viewport_[2], previous_viewport_[3]);
+}
+
+void RenderTarget::Resize(uint32_t width, uint32_t height) {
+  if (width == width_ && height == height_) {
+    return;
+  }
+  Destroy();
+  width_ = width;
+  height_ = height;
+  Create();
+}
+
+void RenderTarget::Create() {
+  texture_ = std::make_shared<Texture2D>(context_);
+  texture_->Internal_Format = GL_RGBA;
+  texture_->Image_Format = GL_RGBA;
+  // sampling past the edges would blend in the opposite side
+  texture_->Wrap_S = GL_CLAMP_TO_EDGE;
+  texture_->Wrap_T = GL_CLAMP_TO_EDGE;
+  texture_->Generate(width_, height_, nullptr);
+
+  context_->GenFramebuffers(1, &framebuffer_);
+  context_->BindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  context_->FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                 GL_TEXTURE_2D, texture_->ID, 0);
+  complete_ = context_->CheckFramebufferStatus(GL_FRAMEBUFFER) ==
+              GL_FRAMEBUFFER_COMPLETE;
+  context_->BindFramebuffer(GL_FRAMEBUFFER, 0);
+  if (!complete_) {
+    std::cout << "Render target " << width_ << "x" << height_
+              << " is incomplete" << std::endl;
+  }
+}
+
+void RenderTarget::Destroy() {
+  context_->DeleteFramebuffers(1, &framebuffer_);
+  framebuffer_ = 0;
+  // whoever still holds the texture keeps a handle to nothing
+  texture_->Release();
+  texture_ = nullptr;
+  complete_ = false;
+}
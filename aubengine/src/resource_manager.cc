@@ -2,21 +2,206 @@
 
 #include <glad/gl.h>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <sstream>
 
+#include "aubengine/file_watcher.h"
+#include "aubengine/metrics.h"
+#include "aubengine/profiler.h"
+#include "aubengine/vfs.h"
 #include "stb_image.h"
 
 // Instantiate static variables
 std::map<std::string, std::shared_ptr<Texture2D>> ResourceManager::Textures;
 std::map<std::string, std::shared_ptr<Shader>> ResourceManager::Shaders;
 
+// Hot reload state. The files every resource came from are always recorded,
+// so hot reload can be enabled at any time; the rest only exists while it is.
+struct ShaderFiles {
+  std::string vertex;
+  std::string fragment;
+};
+struct TextureFile {
+  std::string file;
+  bool alpha = false;
+};
+struct DecodedImage {
+  int width = 0;
+  int height = 0;
+  std::unique_ptr<unsigned char, void (*)(void*)> data{nullptr,
+                                                       stbi_image_free};
+};
+struct ShaderReload {
+  std::string name;
+  std::future<ShaderFiles> sources;
+};
+struct ShaderCompile {
+  std::string name;
+  Shader::PendingProgram pending;
+};
+struct TextureReload {
+  std::string name;
+  std::future<DecodedImage> image;
+};
+
+static std::map<std::string, ShaderFiles> shader_files_;
+static std::map<std::string, TextureFile> texture_files_;
+
+static std::unique_ptr<FileWatcher> watcher_;
+// canonical file path -> names of the resources built from it
+static std::multimap<std::string, std::string> shaders_by_file_;
+static std::multimap<std::string, std::string> textures_by_file_;
+static std::vector<ShaderReload> shader_reloads_;
+static std::vector<ShaderCompile> shader_compiles_;
+static std::vector<TextureReload> texture_reloads_;
+
+// Residency state: textures being streamed back in after an eviction.
+static uint64_t texture_budget_ = 0;
+static TextureResidencyStats residency_stats_;
+static std::vector<TextureReload> texture_stream_ins_;
+
+// Hot reload watches loose files, so it reads them directly: going through
+// the VFS would return the copy in a mounted pack instead of the edit.
+static std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream stream;
+  stream << file.rdbuf();
+  return stream.str();
+}
+
+static void WatchShader(const std::string& name) {
+  const ShaderFiles& files = shader_files_[name];
+  shaders_by_file_.emplace(watcher_->Watch(files.vertex), name);
+  shaders_by_file_.emplace(watcher_->Watch(files.fragment), name);
+}
+
+static void WatchTexture(const std::string& name) {
+  textures_by_file_.emplace(watcher_->Watch(texture_files_[name].file), name);
+}
+
+template <typename T>
+static bool IsReady(const std::future<T>& future) {
+  return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+static void UpdateTextureResidency() {
+  auto& textures = ResourceManager::Textures;
+
+  for (auto it = texture_stream_ins_.begin();
+       it != texture_stream_ins_.end();) {
+    if (!IsReady(it->image)) {
+      ++it;
+      continue;
+    }
+    DecodedImage image = it->image.get();
+    if (image.data) {
+      textures[it->name]->Generate(image.width, image.height,
+                                   image.data.get());
+      ++residency_stats_.stream_ins;
+    } else {
+      std::cout << "Failed to stream in texture " << it->name << std::endl;
+    }
+    it = texture_stream_ins_.erase(it);
+  }
+
+  // binds of evicted textures since the last frame boundary
+  for (const auto& [name, texture] : textures) {
+    if (!texture->stream_in_requested || texture->resident) {
+      continue;
+    }
+    bool streaming = std::any_of(
+        texture_stream_ins_.begin(), texture_stream_ins_.end(),
+        [&name](const TextureReload& load) { return load.name == name; });
+    if (streaming) {
+      continue;
+    }
+    TextureFile file = texture_files_[name];
+    texture_stream_ins_.push_back(
+        {name, std::async(std::launch::async, [file]() {
+           DecodedImage image;
+           int channels;
+           VfsFile bytes = VirtualFileSystem::Read(file.file);
+           image.data.reset(stbi_load_from_memory(
+               bytes.Data(), static_cast<int>(bytes.Size()), &image.width,
+               &image.height, &channels, file.alpha ? 4 : 3));
+           return image;
+         })});
+  }
+
+  uint64_t residentBytes = 0;
+  std::vector<Texture2D*> resident;
+  for (const auto& iter : textures) {
+    if (iter.second->resident) {
+      residentBytes += iter.second->SizeInBytes();
+      resident.push_back(iter.second.get());
+    }
+  }
+
+  if (texture_budget_ != 0 && residentBytes > texture_budget_) {
+    std::sort(resident.begin(), resident.end(),
+              [](const Texture2D* a, const Texture2D* b) {
+                return a->last_used_frame < b->last_used_frame;
+              });
+    for (Texture2D* texture : resident) {
+      // textures bound during this or the previous frame are in use, and
+      // evicting them would only stream them straight back in
+      if (residentBytes <= texture_budget_ ||
+          texture->last_used_frame + 1 >= Texture2D::current_frame) {
+        break;
+      }
+      residentBytes -= texture->SizeInBytes();
+      texture->Release();
+      ++residency_stats_.evictions;
+    }
+  }
+
+  residency_stats_.budget_bytes = texture_budget_;
+  residency_stats_.resident_bytes = residentBytes;
+  residency_stats_.resident_textures = 0;
+  for (const auto& iter : textures) {
+    residency_stats_.resident_textures += iter.second->resident;
+  }
+  residency_stats_.evicted_textures =
+      static_cast<uint32_t>(textures.size()) -
+      residency_stats_.resident_textures;
+  residency_stats_.pending_stream_ins =
+      static_cast<uint32_t>(texture_stream_ins_.size());
+
+  static MetricGauge& residentTextures =
+      Metrics::GetGauge("resources.textures_resident");
+  static MetricGauge& residentTextureBytes =
+      Metrics::GetGauge("resources.texture_bytes_resident");
+  static MetricGauge& pendingStreamIns =
+      Metrics::GetGauge("resources.pending_stream_ins");
+  residentTextures.Set(residency_stats_.resident_textures);
+  residentTextureBytes.Set(double(residency_stats_.resident_bytes));
+  pendingStreamIns.Set(residency_stats_.pending_stream_ins);
+
+  ++Texture2D::current_frame;
+}
+
 std::shared_ptr<Shader> ResourceManager::LoadShader(const char* vShaderFile,
                                                     const char* fShaderFile,
                                                     std::string name,
                                                     GladGLContext* context) {
+  // windows share one GL object namespace, so a shader another window
+  // already loaded under this name is reused instead of compiled again
+  auto it = Shaders.find(name);
+  if (it != Shaders.end()) {
+    return it->second;
+  }
   Shaders[name] = LoadShaderFromFile(vShaderFile, fShaderFile, context);
+  // a headless shader has no program to reload
+  if (context) {
+    shader_files_[name] = {vShaderFile, fShaderFile};
+    if (watcher_) {
+      WatchShader(name);
+    }
+  }
   return Shaders[name];
 }
 
@@ -26,7 +211,18 @@ std::shared_ptr<Shader> ResourceManager::GetShader(std::string name) {
 
 std::shared_ptr<Texture2D> ResourceManager::LoadTexture(
     const char* file, bool alpha, std::string name, GladGLContext* context) {
+  // same as shaders: reuse the texture if any window already uploaded it
+  auto it = Textures.find(name);
+  if (it != Textures.end()) {
+    return it->second;
+  }
   Textures[name] = LoadTextureFromFile(file, alpha, context);
+  if (context) {
+    texture_files_[name] = {file, alpha};
+    if (watcher_) {
+      WatchTexture(name);
+    }
+  }
   return Textures[name];
 }
 
@@ -35,35 +231,156 @@ std::shared_ptr<Texture2D> ResourceManager::GetTexture(std::string name) {
 }
 
 void ResourceManager::Clear(GladGLContext* context) {
+  if (!context) {
+    // headless: the handles own no GL objects
+    Shaders.clear();
+    Textures.clear();
+    return;
+  }
   // (properly) delete all shaders
-  for (const auto& iter : Shaders) context->DeleteProgram(iter.second->id);
+  for (const auto& iter : Shaders) iter.second->Release(context);
   // (properly) delete all textures
   for (const auto& iter : Textures)
     context->DeleteTextures(1, &iter.second->ID);
+  // programs of reloads still in flight were never handed to a Shader
+  for (const auto& compile : shader_compiles_) {
+    context->DeleteShader(compile.pending.vertex);
+    context->DeleteShader(compile.pending.fragment);
+    context->DeleteProgram(compile.pending.program);
+  }
+  // the objects are gone for every context of the share group, so drop the
+  // handles too and let a later Load start from scratch
+  Shaders.clear();
+  Textures.clear();
+  shader_files_.clear();
+  texture_files_.clear();
+  shaders_by_file_.clear();
+  textures_by_file_.clear();
+  shader_reloads_.clear();
+  shader_compiles_.clear();
+  texture_reloads_.clear();
+  texture_stream_ins_.clear();
+}
+
+void ResourceManager::SetTextureBudget(uint64_t bytes) {
+  texture_budget_ = bytes;
+}
+
+TextureResidencyStats ResourceManager::GetTextureResidencyStats() {
+  return residency_stats_;
+}
+
+void ResourceManager::EnableHotReload(bool enabled) {
+  if (!enabled) {
+    watcher_.reset();
+    shaders_by_file_.clear();
+    textures_by_file_.clear();
+    return;
+  }
+
+  if (watcher_) {
+    return;
+  }
+  watcher_ = std::make_unique<FileWatcher>();
+  for (const auto& iter : shader_files_) WatchShader(iter.first);
+  for (const auto& iter : texture_files_) WatchTexture(iter.first);
+}
+
+void ResourceManager::Update() {
+  AUBENGINE_PROFILE_SCOPE("ResourceManager::Update");
+  // Programs issued at the previous frame boundary had a whole frame to be
+  // compiled by the driver, so checking them now should not stall.
+  for (const auto& compile : shader_compiles_) {
+    if (Shaders[compile.name]->EndCompile(compile.pending)) {
+      std::cout << "Reloaded shader " << compile.name << std::endl;
+    } else {
+      std::cout << "Kept previous program of shader " << compile.name
+                << std::endl;
+    }
+  }
+  shader_compiles_.clear();
+
+  UpdateTextureResidency();
+
+  if (!watcher_) {
+    return;
+  }
+
+  // file reads and image decoding run off the main thread
+  for (const auto& file : watcher_->Poll()) {
+    auto shaders = shaders_by_file_.equal_range(file);
+    for (auto it = shaders.first; it != shaders.second; ++it) {
+      ShaderFiles files = shader_files_[it->second];
+      shader_reloads_.push_back(
+          {it->second, std::async(std::launch::async, [files]() {
+             return ShaderFiles{ReadFile(files.vertex),
+                                ReadFile(files.fragment)};
+           })});
+    }
+
+    auto textures = textures_by_file_.equal_range(file);
+    for (auto it = textures.first; it != textures.second; ++it) {
+      TextureFile texture = texture_files_[it->second];
+      texture_reloads_.push_back(
+          {it->second, std::async(std::launch::async, [texture]() {
+             // the texture's format is fixed, so the decoded channel count
+             // must match it whatever the file on disk now holds
+             DecodedImage image;
+             int channels;
+             image.data.reset(stbi_load(texture.file.c_str(), &image.width,
+                                        &image.height, &channels,
+                                        texture.alpha ? 4 : 3));
+             return image;
+           })});
+    }
+  }
+
+  for (auto it = shader_reloads_.begin(); it != shader_reloads_.end();) {
+    if (!IsReady(it->sources)) {
+      ++it;
+      continue;
+    }
+    ShaderFiles sources = it->sources.get();
+    shader_compiles_.push_back(
+        {it->name, Shaders[it->name]->BeginCompile(sources.vertex.c_str(),
+                                                   sources.fragment.c_str())});
+    it = shader_reloads_.erase(it);
+  }
+
+  for (auto it = texture_reloads_.begin(); it != texture_reloads_.end();) {
+    if (!IsReady(it->image)) {
+      ++it;
+      continue;
+    }
+    DecodedImage image = it->image.get();
+    if (image.data) {
+      // re-specifying the image keeps the texture ID, so every holder of the
+      // handle sees the new pixels
+      Textures[it->name]->Generate(image.width, image.height,
+                                   image.data.get());
+      std::cout << "Reloaded texture " << it->name << std::endl;
+    } else {
+      std::cout << "Kept previous image of texture " << it->name << std::endl;
+    }
+    it = texture_reloads_.erase(it);
+  }
 }
 
 std::shared_ptr<Shader> ResourceManager::LoadShaderFromFile(
     const char* vShaderFile, const char* fShaderFile, GladGLContext* context) {
-  // 1. retrieve the vertex/fragment source code from filePath
-  std::string vertexCode;
-  std::string fragmentCode;
-  try {
-    // open files
-    std::ifstream vertexShaderFile(vShaderFile);
-    std::ifstream fragmentShaderFile(fShaderFile);
-    std::stringstream vShaderStream, fShaderStream;
-    // read file's buffer contents into streams
-    vShaderStream << vertexShaderFile.rdbuf();
-    fShaderStream << fragmentShaderFile.rdbuf();
-    // close file handlers
-    vertexShaderFile.close();
-    fragmentShaderFile.close();
-    // convert stream into string
-    vertexCode = vShaderStream.str();
-    fragmentCode = fShaderStream.str();
-  } catch (std::exception e) {
+  // headless: the handle exists so that components can hold it, but there is
+  // nothing to compile
+  if (!context) {
+    return std::make_shared<Shader>(context);
+  }
+  // 1. retrieve the vertex/fragment source code, from a mounted pack or disk
+  VfsFile vertexFile = VirtualFileSystem::Read(vShaderFile);
+  VfsFile fragmentFile = VirtualFileSystem::Read(fShaderFile);
+  if (!vertexFile || !fragmentFile) {
     std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
   }
+  std::string vertexCode(vertexFile.Text());
+  std::string fragmentCode(fragmentFile.Text());
   const char* vShaderCode = vertexCode.c_str();
   const char* fShaderCode = fragmentCode.c_str();
   // 2. now create shader object from source code
@@ -77,13 +394,20 @@ std::shared_ptr<Texture2D> ResourceManager::LoadTextureFromFile(
     const char* file, bool alpha, GladGLContext* context) {
   // create texture object
   std::shared_ptr<Texture2D> texture = std::make_shared<Texture2D>(context);
+  // headless: no pixels are needed, so the image is not even decoded
+  if (!context) {
+    return texture;
+  }
   if (alpha) {
     texture->Internal_Format = GL_RGBA;
     texture->Image_Format = GL_RGBA;
   }
   // load image
   int width, height, nrChannels;
-  unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
+  VfsFile image = VirtualFileSystem::Read(file);
+  unsigned char* data =
+      stbi_load_from_memory(image.Data(), static_cast<int>(image.Size()),
+                            &width, &height, &nrChannels, 0);
   // now generate texture
   texture->Generate(width, height, data);
   // and finally free image data
@@ -1,27 +1,376 @@
 #include "aubengine/scene.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "aubengine/application.h"
+#include "aubengine/components/rigid_body_2d.h"
 #include "aubengine/game_object.h"
+#include "aubengine/metrics.h"
+#include "aubengine/profiler.h"
 #include "aubengine/sprite_renderer.h"
+#include "aubengine/texture_2d.h"
+#include "aubengine/window.h"
 
 Scene::Scene(Window* window, SpriteRenderer* renderer)
-    : window_(window), renderer_(renderer) {}
+    : window_(window), renderer_(renderer), physics_world_({0.0f, -10.0f}) {}
 
-void Scene::PhysicsUpdate() {
+Scene::~Scene() {
+  // the world takes every body with it, so they are not destroyed one by one
+  physics_world_.EndStep();
   for (const auto& go : game_objects_) {
-    go->PhysicsUpdate();
+    if (go->rigid_body_2d) {
+      go->rigid_body_2d->Detach();
+    }
+  }
+}
+
+template <typename F>
+void Scene::ForEachObject(F&& f) {
+  if (!physics_world_.IsDeterministic()) {
+    for (const auto& go : game_objects_) {
+      f(go.get());
+    }
+    return;
+  }
+  // Scripts may spawn objects or touch shared state, so with a deterministic
+  // world they run in id order, the same on every machine, instead of in
+  // pointer hash order. The order is copied, as an object they spawn, or a
+  // snapshot they take, rebuilds it while it is walked.
+  tick_order_ = OrderedObjects();
+  for (GameObject* go : tick_order_) {
+    f(go);
+  }
+}
+
+void Scene::PhysicsUpdate() {
+  AUBENGINE_PROFILE_SCOPE("Scene::PhysicsUpdate");
+  // poses of the step started at the end of the previous tick, which ran
+  // while that frame rendered
+  physics_world_.EndStep();
+  ++tick_;
+  if (snapshot_history_.GetCapacity() != 0) {
+    static MetricGauge& snapshotBytes =
+        Metrics::GetGauge("scene.snapshot_bytes");
+    SaveSnapshot(snapshot_buffer_);
+    snapshot_history_.Push(tick_, snapshot_buffer_);
+    snapshotBytes.Set(double(snapshot_history_.GetStoredBytes()));
+  }
+  DispatchContacts();
+  ForEachObject([](GameObject* go) { go->PhysicsUpdate(); });
+}
+
+void Scene::DispatchContacts() {
+  AUBENGINE_PROFILE_SCOPE("Scene::DispatchContacts");
+  // Handlers may destroy objects, which clears their contacts in place, so
+  // each side is looked up again right before it is called.
+  for (const PhysicsContact& contact : physics_world_.GetContacts()) {
+    DispatchContact(contact.body_a, contact.body_b, contact);
+    DispatchContact(contact.body_b, contact.body_a, contact);
+  }
+}
+
+void Scene::DispatchContact(b2Body* self, b2Body* other,
+                            const PhysicsContact& contact) {
+  if (self == nullptr || other == nullptr) {
+    return;
+  }
+  RigidBody2D* selfOwner = physics_world_.GetOwner(self);
+  RigidBody2D* otherOwner = physics_world_.GetOwner(other);
+  if (selfOwner == nullptr || otherOwner == nullptr) {
+    return;
+  }
+
+  Collision2D collision;
+  collision.other = otherOwner->game_object;
+  collision.is_trigger = contact.is_trigger;
+  if (contact.begin) {
+    selfOwner->game_object->OnCollisionEnter(collision);
+  } else {
+    selfOwner->game_object->OnCollisionExit(collision);
   }
 }
 
 void Scene::Update() {
-  for (const auto& go : game_objects_) {
-    go->Update();
+  AUBENGINE_PROFILE_SCOPE("Scene::Update");
+  ForEachObject([](GameObject* go) { go->Update(); });
+
+  // once every script has run, so the bodies start the next step from the
+  // transforms as game code left them; untouched ones queue nothing
+  physics_commands_.clear();
+  ForEachObject([this](GameObject* go) {
+    if (go->rigid_body_2d) {
+      go->rigid_body_2d->PushTransform(physics_commands_);
+    }
+  });
+  physics_world_.Enqueue(physics_commands_);
+
+  // The step runs on the physics thread until the next tick needs it, in
+  // parallel with the steps of the other scenes.
+  physics_world_.BeginStep(
+      Aubengine::Application::GetInstance().NanosecondsPerUpdate() / 1e9f);
+}
+
+void Scene::Render(float alpha) {
+  AUBENGINE_PROFILE_SCOPE("Scene::Render");
+  {
+    std::scoped_lock lock(snapshot_mutex_);
+    if (!snapshots_published_) {
+      BakeStatic();
+      live_sprites_.clear();
+      for (const auto& go : game_objects_) {
+        if (go->IsStatic()) {
+          continue;
+        }
+        if (!SpriteRenderer::CaptureSprite(go.get(),
+                                           live_sprites_.emplace_back())) {
+          live_sprites_.pop_back();
+        }
+      }
+      if (!layers_.empty()) {
+        RenderLayers(live_sprites_);
+      }
+      DrawStatic();
+      for (const auto& sprite : live_sprites_) {
+        if (sprite.layer < 0) {
+          renderer_->DrawSprite(sprite, alpha);
+        }
+      }
+      return;
+    }
+
+    if (snapshot_fresh_) {
+      std::swap(snapshot_ready_, snapshot_front_);
+      snapshot_fresh_ = false;
+    }
+  }
+
+  // The simulation runs on its own clock here, so the blend factor is how far
+  // into the next tick we are since the drawn capture was taken.
+  auto sinceCapture = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() -
+                          snapshot_front_.time)
+                          .count();
+  alpha = std::clamp(
+      float(sinceCapture) /
+          Aubengine::Application::GetInstance().NanosecondsPerUpdate(),
+      0.0f, 1.0f);
+  if (!layers_.empty()) {
+    RenderLayers(snapshot_front_.sprites);
+  }
+  DrawStatic();
+  for (const auto& sprite : snapshot_front_.sprites) {
+    if (sprite.layer < 0) {
+      renderer_->DrawSprite(sprite, alpha);
+    }
+  }
+}
+
+int32_t Scene::CreateCachedLayer() {
+  layers_.push_back(std::make_unique<CachedLayer>());
+  return int32_t(layers_.size() - 1);
+}
+
+void Scene::InvalidateLayer(int32_t layer) { layers_[layer]->dirty = true; }
+
+void Scene::ReleaseRenderResources() {
+  for (const auto& layer : layers_) {
+    layer->target = nullptr;
+    layer->shader = nullptr;
+    layer->dirty = true;
+  }
+  std::scoped_lock lock(static_mutex_);
+  for (auto& [key, chunk] : static_chunks_) {
+    for (SpriteBatch& batch : chunk.batches) {
+      SpriteRenderer::ReleaseBatch(batch);
+    }
   }
 }
 
-void Scene::Render() {
+void Scene::InvalidateStatic(GameObject* gameObject) {
+  RemoveStatic(gameObject);
+  if (gameObject->IsStatic()) {
+    static_pending_.push_back(gameObject);
+  }
+  static_dirty_ = true;
+}
+
+void Scene::RemoveStatic(GameObject* gameObject) {
+  if (!gameObject->static_placed_) {
+    return;
+  }
+  // only the objects change, not the map, which Render walks
+  StaticChunk& chunk = static_chunks_.find(gameObject->static_chunk_)->second;
+  auto it = std::find(chunk.objects.begin(), chunk.objects.end(), gameObject);
+  *it = chunk.objects.back();
+  chunk.objects.pop_back();
+  chunk.dirty = true;
+  gameObject->static_placed_ = false;
+  static_dirty_ = true;
+}
+
+void Scene::BakeStatic() {
+  if (!static_dirty_) {
+    return;
+  }
+  AUBENGINE_PROFILE_SCOPE("Scene::BakeStatic");
+  static MetricCounter& bakes = Metrics::GetCounter("scene.static_bakes");
+  std::scoped_lock lock(static_mutex_);
+
+  // an object invalidated more than once is only placed once
+  for (GameObject* go : static_pending_) {
+    if (!go->IsStatic() || go->static_placed_ || !go->transform) {
+      continue;
+    }
+    std::pair<int32_t, int32_t> key{
+        int32_t(std::floor(go->transform->position.x / kStaticChunkSize)),
+        int32_t(std::floor(go->transform->position.y / kStaticChunkSize))};
+    StaticChunk& chunk = static_chunks_[key];
+    chunk.objects.push_back(go);
+    chunk.dirty = true;
+    go->static_chunk_ = key;
+    go->static_placed_ = true;
+  }
+  static_pending_.clear();
+
+  SpriteRenderState state;
+  for (auto& [key, chunk] : static_chunks_) {
+    if (!chunk.dirty) {
+      continue;
+    }
+    // batches are kept, emptied, so their buffers are reused
+    for (SpriteBatch& batch : chunk.batches) {
+      batch.vertices.clear();
+      batch.indices.clear();
+      ++batch.revision;
+    }
+    for (GameObject* go : chunk.objects) {
+      if (!SpriteRenderer::CaptureSprite(go, state)) {
+        continue;
+      }
+      auto batch = std::find_if(
+          chunk.batches.begin(), chunk.batches.end(),
+          [&state](const SpriteBatch& batch) {
+            return batch.shader == state.shader &&
+                   batch.texture == state.texture &&
+                   batch.color == state.color &&
+                   batch.context == state.context;
+          });
+      if (batch == chunk.batches.end()) {
+        batch = chunk.batches.emplace(chunk.batches.end());
+        batch->shader = state.shader;
+        batch->texture = state.texture;
+        batch->color = state.color;
+        batch->context = state.context;
+      }
+      SpriteRenderer::BakeSprite(state, *batch);
+    }
+    chunk.dirty = false;
+    bakes.Add();
+  }
+  static_dirty_ = false;
+}
+
+void Scene::DrawStatic() {
+  std::scoped_lock lock(static_mutex_);
+  for (auto& [key, chunk] : static_chunks_) {
+    for (SpriteBatch& batch : chunk.batches) {
+      renderer_->DrawBatch(batch);
+    }
+  }
+}
+
+// splitmix64's finalizer, so that sums of different ids rarely collide
+static uint64_t MixId(uint64_t id) {
+  id = (id ^ (id >> 30)) * 0xbf58476d1ce4e5b9ull;
+  id = (id ^ (id >> 27)) * 0x94d049bb133111ebull;
+  return id ^ (id >> 31);
+}
+
+void Scene::RenderLayers(std::span<const SpriteRenderState> sprites) {
+  AUBENGINE_PROFILE_SCOPE("Scene::RenderLayers");
+  static MetricCounter& redraws = Metrics::GetCounter("scene.layer_redraws");
+  auto context = static_cast<GladGLContext*>(window_->GetContext());
+
+  // A count would miss a sprite leaving as another joins, so the ids of the
+  // members are hashed instead, each scrambled before being summed.
+  for (const auto& layer : layers_) {
+    layer->members = 0;
+  }
+  for (const auto& sprite : sprites) {
+    if (sprite.layer >= 0) {
+      layers_[sprite.layer]->members += MixId(sprite.object_id);
+    }
+  }
+
+  for (int32_t i = 0; i < int32_t(layers_.size()); ++i) {
+    CachedLayer& layer = *layers_[i];
+    if (!layer.dirty.exchange(false) && layer.target &&
+        layer.members == layer.drawn_members) {
+      continue;
+    }
+    if (!layer.target) {
+      layer.target = std::make_unique<RenderTarget>(
+          context, uint32_t(SpriteRenderer::kViewWidth),
+          uint32_t(SpriteRenderer::kViewHeight));
+    }
+
+    // The target keeps colors multiplied by their alpha, so blending into
+    // it twice over does not darken translucent edges.
+    layer.target->Begin();
+    context->BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                               GL_ONE_MINUS_SRC_ALPHA);
+    layer.shader = nullptr;
+    for (const auto& sprite : sprites) {
+      if (sprite.layer == i) {
+        renderer_->DrawSprite(sprite, 1.0f);
+        layer.shader = sprite.shader;
+      }
+    }
+    context->BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    layer.target->End();
+    layer.drawn_members = layer.members;
+    redraws.Add();
+  }
+
+  // a quad covering the whole view, drawn at the pose it was captured at
+  SpriteRenderState quad;
+  quad.context = context;
+  quad.size = {SpriteRenderer::kViewWidth, SpriteRenderer::kViewHeight, 1};
+  quad.position = {SpriteRenderer::kViewWidth / 2,
+                   SpriteRenderer::kViewHeight / 2, 0};
+  quad.previous_position = quad.position;
+  context->BlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+  for (const auto& layer : layers_) {
+    if (!layer->shader) {
+      continue;
+    }
+    quad.shader = layer->shader;
+    quad.texture = layer->target->GetTexture();
+    renderer_->DrawSprite(quad, 1.0f);
+  }
+  context->BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void Scene::PublishRenderState() {
+  AUBENGINE_PROFILE_SCOPE("Scene::PublishRenderState");
+  BakeStatic();
+  snapshot_back_.sprites.clear();
+  SpriteRenderState state;
   for (const auto& go : game_objects_) {
-    renderer_->DrawSprite(go.get());
+    if (go->IsStatic()) {
+      continue;
+    }
+    if (SpriteRenderer::CaptureSprite(go.get(), state)) {
+      snapshot_back_.sprites.push_back(state);
+    }
   }
+  snapshot_back_.time = std::chrono::steady_clock::now();
+
+  std::scoped_lock lock(snapshot_mutex_);
+  std::swap(snapshot_back_, snapshot_ready_);
+  snapshot_fresh_ = true;
+  snapshots_published_ = true;
 }
 
 void Scene::Destroy(GameObject* game_object) {
@@ -31,8 +380,148 @@ void Scene::Destroy(GameObject* game_object) {
                          });
 
   if (it != game_objects_.end()) {
+    if (game_object->IsStatic()) {
+      RemoveStatic(game_object);
+      std::erase(static_pending_, game_object);
+    }
     game_objects_.erase(it);
+    ordered_objects_dirty_ = true;
   }
 }
 
+void Scene::Destroy(std::span<GameObject* const> gameObjects) {
+  std::vector<b2Body*> bodies;
+  for (GameObject* go : gameObjects) {
+    if (go->rigid_body_2d && go->rigid_body_2d->body) {
+      bodies.push_back(go->rigid_body_2d->body);
+      go->rigid_body_2d->Detach();
+    }
+  }
+  physics_world_.DestroyBodies(bodies);
+
+  std::unordered_set<GameObject*> doomed(gameObjects.begin(),
+                                         gameObjects.end());
+  for (GameObject* go : gameObjects) {
+    if (go->IsStatic()) {
+      RemoveStatic(go);
+    }
+  }
+  if (!static_pending_.empty()) {
+    std::erase_if(static_pending_,
+                  [&doomed](GameObject* go) { return doomed.contains(go); });
+  }
+  std::erase_if(game_objects_, [&doomed](const auto& go) {
+    return doomed.contains(go.get());
+  });
+  ordered_objects_dirty_ = true;
+}
+
+const std::vector<GameObject*>& Scene::OrderedObjects() {
+  if (ordered_objects_dirty_) {
+    ordered_objects_.clear();
+    for (const auto& go : game_objects_) {
+      ordered_objects_.push_back(go.get());
+    }
+    std::sort(ordered_objects_.begin(), ordered_objects_.end(),
+              [](const GameObject* a, const GameObject* b) {
+                return a->GetId() < b->GetId();
+              });
+    ordered_objects_dirty_ = false;
+  }
+  return ordered_objects_;
+}
+
+void Scene::SaveSnapshot(std::vector<std::byte>& snapshot) {
+  AUBENGINE_PROFILE_SCOPE("Scene::SaveSnapshot");
+  physics_world_.EndStep();
+  snapshot.clear();
+  SnapshotWriter writer(snapshot);
+  const auto& objects = OrderedObjects();
+  writer.Write(tick_);
+  writer.Write(next_object_id_);
+  writer.Write(uint32_t(objects.size()));
+  for (const GameObject* go : objects) {
+    // each object's state is sized, so objects gone since can be skipped
+    writer.Write(go->GetId());
+    size_t sizeOffset = writer.Size();
+    writer.Write(uint32_t(0));
+    go->SaveState(writer);
+    writer.WriteAt(sizeOffset,
+                   uint32_t(writer.Size() - sizeOffset - sizeof(uint32_t)));
+  }
+}
+
+void Scene::LoadSnapshot(std::span<const std::byte> snapshot) {
+  AUBENGINE_PROFILE_SCOPE("Scene::LoadSnapshot");
+  physics_world_.DiscardPending();
+  SnapshotReader reader(snapshot);
+  uint64_t tick = 0;
+  uint64_t nextObjectId = 0;
+  uint32_t count = 0;
+  reader.Read(tick);
+  reader.Read(nextObjectId);
+  reader.Read(count);
+
+  // Objects created after the snapshot belong to the ticks undone; ids only
+  // grow, so they are the last ones in id order.
+  {
+    const auto& ordered = OrderedObjects();
+    auto created = std::upper_bound(
+        ordered.begin(), ordered.end(), nextObjectId,
+        [](uint64_t id, const GameObject* go) { return id < go->GetId(); });
+    if (created != ordered.end()) {
+      std::vector<GameObject*> doomed(created, ordered.end());
+      Destroy(doomed);
+    }
+  }
+  next_object_id_ = nextObjectId;
+
+  // both lists are in id order, so finding each object is a merge
+  const auto& objects = OrderedObjects();
+  auto next = objects.begin();
+  for (uint32_t i = 0; i < count; ++i) {
+    uint64_t id = 0;
+    uint32_t size = 0;
+    if (!reader.Read(id) || !reader.Read(size)) {
+      break;
+    }
+    next = std::lower_bound(next, objects.end(), id,
+                            [](const GameObject* go, uint64_t id) {
+                              return go->GetId() < id;
+                            });
+    if (next != objects.end() && (*next)->GetId() == id) {
+      SnapshotReader objectReader(snapshot.subspan(
+          reader.Offset(), std::min<size_t>(size, snapshot.size() -
+                                                      reader.Offset())));
+      (*next)->LoadState(objectReader);
+    }
+    reader.Skip(size);
+  }
+
+  // restored objects may be anywhere, and objects spawned again reuse the
+  // ids of the ones destroyed above
+  for (const auto& layer : layers_) {
+    layer->dirty = true;
+  }
+
+  // the tick is run again by the next PhysicsUpdate
+  tick_ = tick != 0 ? tick - 1 : 0;
+}
+
+void Scene::SetSnapshotHistory(uint32_t ticks) {
+  snapshot_history_ = SnapshotHistory(ticks);
+}
+
+bool Scene::Rollback(uint64_t tick) {
+  if (!snapshot_history_.Get(tick, snapshot_buffer_)) {
+    return false;
+  }
+  LoadSnapshot(snapshot_buffer_);
+  // the ticks after are about to be run again
+  snapshot_history_.Rewind(tick, snapshot_buffer_);
+  return true;
+}
+
+PhysicsWorld& Scene::GetPhysicsWorld() { return physics_world_; }
+
 Window* Scene::GetWindow() { return window_; }
\ No newline at end of file
@@ -7,29 +7,112 @@ Shader::Shader(GladGLContext* context): context_(context) { }
 void Shader::Use() { context_->UseProgram(this->id); }
 
 void Shader::Compile(const char* vertexSource, const char* fragmentSource) {
+  this->id = Link(context_, vertexSource, fragmentSource);
+  std::scoped_lock lock(programs_mutex_);
+  vertex_source_ = vertexSource;
+  fragment_source_ = fragmentSource;
+  ++revision_;
+}
+
+unsigned int Shader::Link(GladGLContext* context, const char* vertexSource,
+                          const char* fragmentSource) {
   unsigned int sVertex, sFragment;
   // vertex Shader
-  sVertex = context_->CreateShader(GL_VERTEX_SHADER);
-  context_->ShaderSource(sVertex, 1, &vertexSource, NULL);
-  context_->CompileShader(sVertex);
-  CheckCompileErrors(sVertex, "VERTEX");
+  sVertex = context->CreateShader(GL_VERTEX_SHADER);
+  context->ShaderSource(sVertex, 1, &vertexSource, NULL);
+  context->CompileShader(sVertex);
+  CheckCompileErrors(context, sVertex, "VERTEX");
   // fragment Shader
-  sFragment = context_->CreateShader(GL_FRAGMENT_SHADER);
-  context_->ShaderSource(sFragment, 1, &fragmentSource, NULL);
-  context_->CompileShader(sFragment);
-  CheckCompileErrors(sFragment, "FRAGMENT");
+  sFragment = context->CreateShader(GL_FRAGMENT_SHADER);
+  context->ShaderSource(sFragment, 1, &fragmentSource, NULL);
+  context->CompileShader(sFragment);
+  CheckCompileErrors(context, sFragment, "FRAGMENT");
 
   // shader program
-  this->id = context_->CreateProgram();
-  context_->AttachShader(this->id, sVertex);
-  context_->AttachShader(this->id, sFragment);
-  context_->LinkProgram(this->id);
-  CheckCompileErrors(this->id, "PROGRAM");
+  unsigned int program = context->CreateProgram();
+  context->AttachShader(program, sVertex);
+  context->AttachShader(program, sFragment);
+  context->LinkProgram(program);
+  CheckCompileErrors(context, program, "PROGRAM");
 
   // delete the shaders as they're linked into our program now and no longer
   // necessary
-  context_->DeleteShader(sVertex);
-  context_->DeleteShader(sFragment);
+  context->DeleteShader(sVertex);
+  context->DeleteShader(sFragment);
+  return program;
+}
+
+Shader::PendingProgram Shader::BeginCompile(const char* vertexSource,
+                                            const char* fragmentSource) {
+  PendingProgram pending;
+  pending.vertex_source = vertexSource;
+  pending.fragment_source = fragmentSource;
+  pending.vertex = context_->CreateShader(GL_VERTEX_SHADER);
+  context_->ShaderSource(pending.vertex, 1, &vertexSource, NULL);
+  context_->CompileShader(pending.vertex);
+  pending.fragment = context_->CreateShader(GL_FRAGMENT_SHADER);
+  context_->ShaderSource(pending.fragment, 1, &fragmentSource, NULL);
+  context_->CompileShader(pending.fragment);
+
+  pending.program = context_->CreateProgram();
+  context_->AttachShader(pending.program, pending.vertex);
+  context_->AttachShader(pending.program, pending.fragment);
+  context_->LinkProgram(pending.program);
+  return pending;
+}
+
+bool Shader::EndCompile(const PendingProgram& pending) {
+  // querying the status is what blocks on the driver, so it is left for
+  // when the caller decides the compilation had time to finish
+  bool success = CheckCompileErrors(context_, pending.vertex, "VERTEX");
+  success &= CheckCompileErrors(context_, pending.fragment, "FRAGMENT");
+  success &= CheckCompileErrors(context_, pending.program, "PROGRAM");
+
+  context_->DeleteShader(pending.vertex);
+  context_->DeleteShader(pending.fragment);
+  if (!success) {
+    context_->DeleteProgram(pending.program);
+    return false;
+  }
+
+  context_->DeleteProgram(this->id);
+  this->id = pending.program;
+  // the copies of other contexts are relinked the next time they draw
+  std::scoped_lock lock(programs_mutex_);
+  vertex_source_ = pending.vertex_source;
+  fragment_source_ = pending.fragment_source;
+  ++revision_;
+  return true;
+}
+
+unsigned int Shader::GetProgram(GladGLContext* context) {
+  if (context == context_) {
+    return this->id;
+  }
+  std::scoped_lock lock(programs_mutex_);
+  ContextProgram& copy = programs_[context];
+  if (copy.program != 0 && copy.revision == revision_) {
+    return copy.program;
+  }
+  // programs are shared by the contexts of a share group, so the stale copy
+  // can be deleted from the context that used it
+  if (copy.program != 0) {
+    context->DeleteProgram(copy.program);
+  }
+  copy.program =
+      Link(context, vertex_source_.c_str(), fragment_source_.c_str());
+  copy.revision = revision_;
+  return copy.program;
+}
+
+void Shader::Release(GladGLContext* context) {
+  std::scoped_lock lock(programs_mutex_);
+  context->DeleteProgram(this->id);
+  for (const auto& [_, copy] : programs_) {
+    context->DeleteProgram(copy.program);
+  }
+  this->id = 0;
+  programs_.clear();
 }
 
 void Shader::SetFloat(const char* name, float value, bool useShader) {
@@ -88,13 +171,14 @@ void Shader::SetMatrix4(const char* name, const glm::mat4& matrix,
                              false, glm::value_ptr(matrix));
 }
 
-void Shader::CheckCompileErrors(unsigned int object, std::string type) {
+bool Shader::CheckCompileErrors(GladGLContext* context, unsigned int object,
+                                std::string type) {
   int success;
   char infoLog[1024];
   if (type != "PROGRAM") {
-    context_->GetShaderiv(object, GL_COMPILE_STATUS, &success);
+    context->GetShaderiv(object, GL_COMPILE_STATUS, &success);
     if (!success) {
-      context_->GetShaderInfoLog(object, 1024, NULL, infoLog);
+      context->GetShaderInfoLog(object, 1024, NULL, infoLog);
       std::cout
           << "| ERROR::SHADER: Compile-time error: Type: " << type << "\n"
           << infoLog
@@ -102,9 +186,9 @@ void Shader::CheckCompileErrors(unsigned int object, std::string type) {
           << std::endl;
     }
   } else {
-    context_->GetProgramiv(object, GL_LINK_STATUS, &success);
+    context->GetProgramiv(object, GL_LINK_STATUS, &success);
     if (!success) {
-      context_->GetProgramInfoLog(object, 1024, NULL, infoLog);
+      context->GetProgramInfoLog(object, 1024, NULL, infoLog);
       std::cout
           << "| ERROR::Shader: Link-time error: Type: " << type << "\n"
           << infoLog
@@ -112,4 +196,5 @@ void Shader::CheckCompileErrors(unsigned int object, std::string type) {
           << std::endl;
     }
   }
+  return success;
 }
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "aubengine/snapshot.h"
+
+#include <utility>
+
+SnapshotHistory::SnapshotHistory(uint32_t capacity)
+    : capacity_(capacity), entries_(capacity > 1 ? capacity - 1 : 0) {}
+
+void SnapshotHistory::Push(uint64_t tick,
+                           std::span<const std::byte> snapshot) {
+  if (capacity_ == 0) {
+    return;
+  }
+
+  size_t ring = entries_.size();
+  if (has_newest_ && tick == newest_tick_) {
+    // the tick before was stored against the snapshot being replaced
+    if (count_ != 0) {
+      Entry& previous = entries_[(head_ + count_ - 1) % ring];
+      if (previous.is_delta) {
+        std::vector<std::byte> older = newest_;
+        ApplyDelta(previous.data, older);
+        if (older.size() == snapshot.size()) {
+          EncodeDelta(older, snapshot, previous.data);
+        } else {
+          previous.is_delta = false;
+          previous.data = std::move(older);
+        }
+      }
+    }
+    newest_.assign(snapshot.begin(), snapshot.end());
+    return;
+  }
+
+  if (has_newest_ && ring != 0) {
+    // once the ring is full, the oldest slot and its buffer are reused
+    Entry* entry = nullptr;
+    if (count_ < ring) {
+      entry = &entries_[(head_ + count_) % ring];
+      ++count_;
+    } else {
+      entry = &entries_[head_];
+      head_ = (head_ + 1) % ring;
+    }
+    entry->tick = newest_tick_;
+    entry->is_delta = newest_.size() == snapshot.size();
+    if (entry->is_delta) {
+      EncodeDelta(newest_, snapshot, entry->data);
+    } else {
+      entry->data = newest_;
+    }
+  }
+  newest_.assign(snapshot.begin(), snapshot.end());
+  newest_tick_ = tick;
+  has_newest_ = true;
+}
+
+bool SnapshotHistory::Get(uint64_t tick,
+                          std::vector<std::byte>& snapshot) const {
+  if (!has_newest_ || tick > newest_tick_) {
+    return false;
+  }
+  snapshot = newest_;
+  if (tick == newest_tick_) {
+    return true;
+  }
+
+  // from the newest back, each delta turning a snapshot into the one before
+  size_t ring = entries_.size();
+  for (size_t i = count_; i-- > 0;) {
+    const Entry& entry = entries_[(head_ + i) % ring];
+    if (entry.is_delta) {
+      ApplyDelta(entry.data, snapshot);
+    } else {
+      snapshot = entry.data;
+    }
+    if (entry.tick == tick) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SnapshotHistory::Rewind(uint64_t tick,
+                             std::span<const std::byte> snapshot) {
+  size_t ring = entries_.size();
+  while (count_ != 0 && entries_[(head_ + count_ - 1) % ring].tick >= tick) {
+    --count_;
+  }
+  newest_.assign(snapshot.begin(), snapshot.end());
+  newest_tick_ = tick;
+  has_newest_ = true;
+}
+
+void SnapshotHistory::Clear() {
+  head_ = 0;
+  count_ = 0;
+  newest_.clear();
+  has_newest_ = false;
+}
+
+size_t SnapshotHistory::GetStoredBytes() const {
+  size_t bytes = newest_.size();
+  size_t ring = entries_.size();
+  for (size_t i = 0; i < count_; ++i) {
+    bytes += entries_[(head_ + i) % ring].data.size();
+  }
+  return bytes;
+}
+
+// Runs of unchanged bytes shorter than this are kept inside a literal run,
+// as a new run would cost more than the bytes it skips.
+static constexpr size_t kMinZeroRun = 8;
+
+static void AppendRun(std::vector<std::byte>& delta, uint32_t zeros,
+                      uint32_t literals) {
+  size_t offset = delta.size();
+  delta.resize(offset + sizeof(zeros) + sizeof(literals));
+  std::memcpy(delta.data() + offset, &zeros, sizeof(zeros));
+  std::memcpy(delta.data() + offset + sizeof(zeros), &literals,
+              sizeof(literals));
+}
+
+void SnapshotHistory::EncodeDelta(std::span<const std::byte> from,
+                                  std::span<const std::byte> to,
+                                  std::vector<std::byte>& delta) {
+  // runs of [unchanged count][changed count][changed bytes, XORed]
+  delta.clear();
+  size_t size = from.size();
+  size_t i = 0;
+  while (i < size) {
+    size_t start = i;
+    while (i < size && from[i] == to[i]) {
+      ++i;
+    }
+    uint32_t zeros = uint32_t(i - start);
+    if (i == size) {
+      break;
+    }
+
+    start = i;
+    size_t end = i;
+    while (i < size) {
+      if (from[i] != to[i]) {
+        end = ++i;
+        continue;
+      }
+      size_t same = i;
+      while (same < size && same - i < kMinZeroRun && from[same] == to[same]) {
+        ++same;
+      }
+      if (same - i == kMinZeroRun || same == size) {
+        break;
+      }
+      i = same;
+    }
+    i = end;
+
+    AppendRun(delta, zeros, uint32_t(end - start));
+    for (size_t j = start; j < end; ++j) {
+      delta.push_back(from[j] ^ to[j]);
+    }
+  }
+}
+
+void SnapshotHistory::ApplyDelta(std::span<const std::byte> delta,
+                                 std::vector<std::byte>& snapshot) {
+  size_t position = 0;
+  size_t offset = 0;
+  while (offset + 2 * sizeof(uint32_t) <= delta.size()) {
+    uint32_t zeros = 0;
+    uint32_t literals = 0;
+    std::memcpy(&zeros, delta.data() + offset, sizeof(zeros));
+    std::memcpy(&literals, delta.data() + offset + sizeof(zeros),
+                sizeof(literals));
+    offset += sizeof(zeros) + sizeof(literals);
+    position += zeros;
+    for (uint32_t j = 0; j < literals; ++j) {
+      snapshot[position++] ^= delta[offset++];
+    }
+  }
+}
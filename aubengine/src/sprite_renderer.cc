@@ -1,48 +1,323 @@
 #include "aubengine/sprite_renderer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
 #include "aubengine/components/sprite_renderer_2d.h"
 #include "aubengine/components/transform.h"
+#include "aubengine/metrics.h"
+#include "aubengine/shader.h"
+#include "aubengine/texture_2d.h"
+
+// What draws through the renderer last bound on this thread, to count the
+// binds that actually change state. A context is current on one thread at
+// a time, and tracking starts over whenever draws switch contexts.
+struct BoundState {
+  GladGLContext* context = nullptr;
+  unsigned int program = ~0u;
+  unsigned int texture = ~0u;
+  unsigned int vertex_array = ~0u;
+};
+static thread_local BoundState bound_;
+
+static uint64_t Bind(unsigned int& bound, unsigned int object) {
+  if (bound == object) {
+    return 0;
+  }
+  bound = object;
+  return 1;
+}
+
+// state changes of a draw binding program, texture and vertex array; the
+// vertex array is left bound, so back to back quads bind it only once
+static uint64_t CountStateChanges(GladGLContext* context, unsigned int program,
+                                  unsigned int texture,
+                                  unsigned int vertexArray) {
+  if (bound_.context != context) {
+    bound_ = BoundState();
+    bound_.context = context;
+  }
+  return Bind(bound_.program, program) + Bind(bound_.texture, texture) +
+         Bind(bound_.vertex_array, vertexArray);
+}
 
-void SpriteRenderer::DrawSprite(GameObject* go) {
+// binds the context's copy of the shader and sets the uniforms of a draw
+static unsigned int UseShader(GladGLContext* context, Shader& shader,
+                              const glm::mat4& model, const glm::vec3& color) {
+  unsigned int program = shader.GetProgram(context);
+  glm::mat4 projection = glm::ortho(0.0f, SpriteRenderer::kViewWidth, 0.0f,
+                                    SpriteRenderer::kViewHeight);
+  context->UseProgram(program);
+  context->Uniform1i(context->GetUniformLocation(program, "image"), 0);
+  context->UniformMatrix4fv(context->GetUniformLocation(program, "model"), 1,
+                            false, glm::value_ptr(model));
+  context->UniformMatrix4fv(context->GetUniformLocation(program, "projection"),
+                            1, false, glm::value_ptr(projection));
+  context->Uniform3f(context->GetUniformLocation(program, "spriteColor"),
+                     color.x, color.y, color.z);
+  return program;
+}
+
+void SpriteRenderer::DrawSprite(GameObject* go, float alpha) {
+  SpriteRenderState state;
+  if (!CaptureSprite(go, state)) {
+    return;
+  }
+
+  DrawSprite(state, alpha);
+}
+
+bool SpriteRenderer::CaptureSprite(GameObject* go, SpriteRenderState& state) {
   SpriteRenderer2D* sprite = go->GetComponent<SpriteRenderer2D>();
 
   if (!go->transform || !sprite) {
+    return false;
+  }
+
+  state.shader = sprite->shader_;
+  state.texture = sprite->texture_2d_;
+  state.color = sprite->color_;
+  state.layer = sprite->layer_;
+  state.context = sprite->context_;
+  state.object_id = go->GetId();
+  // interpolating at alpha 0 and 1 yields exactly the two states, including
+  // for objects that have not been through a tick yet
+  state.previous_position = go->transform->InterpolatedPosition(0.0f);
+  state.position = go->transform->position;
+  state.size = go->transform->size;
+  state.previous_euler_rotation =
+      go->transform->InterpolatedEulerRotation(0.0f);
+  state.euler_rotation = go->transform->euler_rotation;
+  return true;
+}
+
+void SpriteRenderer::DrawSprite(const SpriteRenderState& state, float alpha) {
+  static MetricCounter& submitted =
+      Metrics::GetCounter("renderer.sprites_submitted");
+  static MetricCounter& culled = Metrics::GetCounter("renderer.sprites_culled");
+  static MetricCounter& drawCalls = Metrics::GetCounter("renderer.draw_calls");
+  static MetricCounter& stateChanges =
+      Metrics::GetCounter("renderer.state_changes");
+  // captured headless, where there is nothing to draw with
+  if (state.context == nullptr) {
+    return;
+  }
+  submitted.Add();
+
+  glm::vec3 position = state.previous_position +
+                       (state.position - state.previous_position) * alpha;
+  glm::vec3 rotation =
+      state.previous_euler_rotation +
+      (state.euler_rotation - state.previous_euler_rotation) * alpha;
+
+  // Whatever the rotation, the quad stays within its size's length of the
+  // pivot it rotates around, which makes a cheap conservative bound.
+  glm::vec2 pivot = glm::vec2(position) + 0.5f * glm::vec2(state.size);
+  float radius = glm::length(glm::vec2(state.size));
+  if (pivot.x + radius < 0.0f || pivot.x - radius > kViewWidth ||
+      pivot.y + radius < 0.0f || pivot.y - radius > kViewHeight) {
+    culled.Add();
     return;
   }
 
   // prepare transformations
-  sprite->shader_->Use();
   glm::mat4 model = glm::mat4(1.0f);
   model = glm::translate(
       model,
-      go->transform->position);  // first translate (transformations are: scale
-                                 // happens first, then rotation, and then final
-                                 // translation happens; reversed order)
+      position);  // first translate (transformations are: scale happens
+                  // first, then rotation, and then final translation
+                  // happens; reversed order)
 
   model = glm::translate(
-      model,
-      glm::vec3(0.5f * go->transform->size.x, 0.5f * go->transform->size.y,
-                0.0f));  // move origin of rotation to center of quad
-  model = glm::rotate(model, glm::radians(go->transform->euler_rotation.z),
+      model, glm::vec3(0.5f * state.size.x, 0.5f * state.size.y,
+                       0.0f));  // move origin of rotation to center of quad
+  model = glm::rotate(model, glm::radians(rotation.z),
                       glm::vec3(0.0f, 0.0f, 1.0f));  // then rotate
-  model = glm::translate(model, glm::vec3(-0.5f * go->transform->size.x,
-                                          -0.5f * go->transform->size.y,
+  model = glm::translate(model, glm::vec3(-0.5f * state.size.x,
+                                          -0.5f * state.size.y,
                                           0.0f));  // move origin back
 
-  model = glm::scale(model, go->transform->size);  // last scale
-  auto projection = glm::ortho(0.0f, 800.0f, 0.0f, 600.0f);
-
-  sprite->shader_->SetInteger("image", 0);
-  sprite->shader_->SetMatrix4("model", model);
-  sprite->shader_->SetMatrix4("projection", projection);
-  sprite->shader_->SetVector3f("spriteColor", sprite->color_);
+  model = glm::scale(model, state.size);  // last scale
+  unsigned int program =
+      UseShader(state.context, *state.shader, model, state.color);
 
   // render textured quad
 
-  sprite->context_->ActiveTexture(GL_TEXTURE0);
-  sprite->texture_2d_->Bind();
+  state.context->ActiveTexture(GL_TEXTURE0);
+  state.texture->Bind();
+
+  unsigned int quad = GetQuad(state.context);
+  state.context->BindVertexArray(quad);
+  state.context->DrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  drawCalls.Add();
+  stateChanges.Add(
+      CountStateChanges(state.context, program, state.texture->ID, quad));
+}
+
+void SpriteRenderer::BakeSprite(const SpriteRenderState& state,
+                                SpriteBatch& batch) {
+  // the corners of the unit quad and their texture coordinates, as GetQuad
+  // lays them out
+  static constexpr float kCorners[4][4] = {
+      {0.5f, 0.5f, 1.0f, 1.0f},
+      {0.5f, -0.5f, 1.0f, 0.0f},
+      {-0.5f, -0.5f, 0.0f, 0.0f},
+      {-0.5f, 0.5f, 0.0f, 1.0f},
+  };
+  static constexpr uint32_t kIndices[] = {0, 1, 3, 1, 2, 3};
+
+  // the model matrix DrawSprite builds, applied on the CPU once and for all:
+  // scaled, rotated around the pivot at half the size, then translated
+  float angle = glm::radians(state.euler_rotation.z);
+  float cos = std::cos(angle);
+  float sin = std::sin(angle);
+  glm::vec2 half = 0.5f * glm::vec2(state.size);
+  glm::vec2 pivot = glm::vec2(state.position) + half;
+
+  bool first = batch.vertices.empty();
+  uint32_t base = uint32_t(batch.vertices.size() / 4);
+  for (const auto& corner : kCorners) {
+    glm::vec2 local{corner[0] * state.size.x - half.x,
+                    corner[1] * state.size.y - half.y};
+    glm::vec2 world{pivot.x + local.x * cos - local.y * sin,
+                    pivot.y + local.x * sin + local.y * cos};
+    batch.vertices.insert(batch.vertices.end(),
+                          {world.x, world.y, corner[2], corner[3]});
+    if (first) {
+      batch.min = world;
+      batch.max = world;
+      first = false;
+    }
+    batch.min = {std::min(batch.min.x, world.x),
+                 std::min(batch.min.y, world.y)};
+    batch.max = {std::max(batch.max.x, world.x),
+                 std::max(batch.max.y, world.y)};
+  }
+  for (uint32_t index : kIndices) {
+    batch.indices.push_back(base + index);
+  }
+  ++batch.revision;
+}
+
+void SpriteRenderer::DrawBatch(SpriteBatch& batch) {
+  static MetricCounter& batched =
+      Metrics::GetCounter("renderer.sprites_batched");
+  static MetricCounter& drawCalls = Metrics::GetCounter("renderer.draw_calls");
+  static MetricCounter& stateChanges =
+      Metrics::GetCounter("renderer.state_changes");
+  if (batch.context == nullptr || batch.indices.empty() || batch.max.x < 0.0f ||
+      batch.min.x > kViewWidth || batch.max.y < 0.0f ||
+      batch.min.y > kViewHeight) {
+    return;
+  }
+
+  GladGLContext* context = batch.context;
+  if (batch.vao == 0) {
+    context->GenVertexArrays(1, &batch.vao);
+    context->GenBuffers(1, &batch.vbo);
+    context->GenBuffers(1, &batch.ebo);
+    context->BindVertexArray(batch.vao);
+    context->BindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+    context->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.ebo);
+    context->VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float),
+                                 (void*)0);
+    context->EnableVertexAttribArray(0);
+    context->VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float),
+                                 (void*)(2 * sizeof(float)));
+    context->EnableVertexAttribArray(1);
+  } else {
+    context->BindVertexArray(batch.vao);
+  }
+  if (batch.uploaded_revision != batch.revision) {
+    context->BindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+    context->BufferData(GL_ARRAY_BUFFER,
+                        batch.vertices.size() * sizeof(float),
+                        batch.vertices.data(), GL_STATIC_DRAW);
+    context->BufferData(GL_ELEMENT_ARRAY_BUFFER,
+                        batch.indices.size() * sizeof(uint32_t),
+                        batch.indices.data(), GL_STATIC_DRAW);
+    batch.uploaded_revision = batch.revision;
+  }
+
+  // the vertices are in world space already
+  unsigned int program =
+      UseShader(context, *batch.shader, glm::mat4(1.0f), batch.color);
+  context->ActiveTexture(GL_TEXTURE0);
+  batch.texture->Bind();
+  context->DrawElements(GL_TRIANGLES, GLsizei(batch.indices.size()),
+                        GL_UNSIGNED_INT, 0);
+  batched.Add(batch.indices.size() / 6);
+  drawCalls.Add();
+  stateChanges.Add(
+      CountStateChanges(context, program, batch.texture->ID, batch.vao));
+}
+
+void SpriteRenderer::ReleaseBatch(SpriteBatch& batch) {
+  if (batch.vao == 0) {
+    return;
+  }
+  // deleting the bound vertex array unbinds it
+  if (bound_.context == batch.context && bound_.vertex_array == batch.vao) {
+    bound_.vertex_array = 0;
+  }
+  batch.context->DeleteVertexArrays(1, &batch.vao);
+  batch.context->DeleteBuffers(1, &batch.vbo);
+  batch.context->DeleteBuffers(1, &batch.ebo);
+  batch.vao = 0;
+  batch.vbo = 0;
+  batch.ebo = 0;
+  batch.uploaded_revision = 0;
+}
+
+unsigned int SpriteRenderer::GetQuad(GladGLContext* context) {
+  std::scoped_lock lock(quads_mutex_);
+  auto it = quad_vaos_.find(context);
+  if (it != quad_vaos_.end()) {
+    return it->second;
+  }
+
+  float vertices[] = {
+      // pos			    // tex
+      0.5f,  0.5f,  1.0f, 1.0f, 0.5f,  -0.5f, 1.0f, 0.0f,
+      -0.5f, -0.5f, 0.0f, 0.0f, -0.5f, 0.5f,  0.0f, 1.0f,
+  };
+
+  unsigned int indices[] = {0, 1, 3, 1, 2, 3};
+
+  unsigned int vao = 0;
+  unsigned int ebo = 0;
+  unsigned int vbo = 0;
+  context->GenVertexArrays(1, &vao);
+  context->GenBuffers(1, &ebo);
+  context->GenBuffers(1, &vbo);
+
+  context->BindVertexArray(vao);
+
+  context->BindBuffer(GL_ARRAY_BUFFER, vbo);
+  context->BufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices,
+                      GL_STATIC_DRAW);
+
+  context->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+  context->BufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices,
+                      GL_STATIC_DRAW);
+
+  // Position
+  context->VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float),
+                               (void*)0);
+  context->EnableVertexAttribArray(0);
+  // TexCoord
+  context->VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float),
+                               (void*)(2 * sizeof(float)));
+  context->EnableVertexAttribArray(1);
+
+  context->BindVertexArray(0);
+  // whatever the thread last drew with is no longer bound
+  if (bound_.context == context) {
+    bound_.vertex_array = 0;
+  }
 
-  sprite->context_->BindVertexArray(sprite->quad_vao_);
-  sprite->context_->DrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-  sprite->context_->BindVertexArray(0);
-}
\ No newline at end of file
+  quad_vaos_[context] = vao;
+  return vao;
+}
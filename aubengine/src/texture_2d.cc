@@ -2,6 +2,8 @@
 
 #include "aubengine/texture_2d.h"
 
+uint64_t Texture2D::current_frame = 0;
+
 Texture2D::Texture2D(GladGLContext* context)
     : Width(0),
       Height(0),
@@ -12,13 +14,21 @@ Texture2D::Texture2D(GladGLContext* context)
       Filter_Min(GL_LINEAR),
       Filter_Max(GL_LINEAR) {
   _context = context;
-  _context->GenTextures(1, &this->ID);
+  // without a context (headless) the texture is only a handle
+  if (_context) {
+    _context->GenTextures(1, &this->ID);
+  }
 }
 
 void Texture2D::Generate(unsigned int width, unsigned int height,
                          unsigned char* data) {
   this->Width = width;
   this->Height = height;
+  if (this->ID == 0) {
+    _context->GenTextures(1, &this->ID);
+  }
+  resident = true;
+  stream_in_requested = false;
   // create Texture
   _context->BindTexture(GL_TEXTURE_2D, this->ID);
   _context->TexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height,
@@ -34,4 +44,25 @@ void Texture2D::Generate(unsigned int width, unsigned int height,
   _context->BindTexture(GL_TEXTURE_2D, 0);
 }
 
-void Texture2D::Bind() const { _context->BindTexture(GL_TEXTURE_2D, this->ID); }
\ No newline at end of file
+void Texture2D::Release() {
+  // headless, or already released: there is no texture object
+  if (this->ID == 0) {
+    return;
+  }
+  _context->DeleteTextures(1, &this->ID);
+  this->ID = 0;
+  resident = false;
+}
+
+uint64_t Texture2D::SizeInBytes() const {
+  uint64_t bytesPerPixel = this->Internal_Format == GL_RGBA ? 4 : 3;
+  return uint64_t(this->Width) * this->Height * bytesPerPixel;
+}
+
+void Texture2D::Bind() const {
+  last_used_frame.store(current_frame, std::memory_order_relaxed);
+  if (!resident) {
+    stream_in_requested.store(true, std::memory_order_relaxed);
+  }
+  _context->BindTexture(GL_TEXTURE_2D, this->ID);
+}
\ No newline at end of file
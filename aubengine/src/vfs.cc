@@ -0,0 +1,250 @@
+#include "aubengine/vfs.h"
+
+#include <lz4.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include "aubengine/pack_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// LZ4 decodes through ints, and no block expands more than 255 times over
+static constexpr uint64_t kMaxDecodedSize = std::numeric_limits<int>::max();
+static constexpr uint64_t kMaxLZ4Ratio = 255;
+
+// A pack file mapped read-only into memory, together with where it is
+// mounted.
+class MountedPack {
+ public:
+  ~MountedPack() {
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#else
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+  }
+
+  bool Map(const std::string& path) {
+#ifdef _WIN32
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_ == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) return false;
+    size_ = static_cast<size_t>(size.QuadPart);
+    mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping_) return false;
+    data_ = static_cast<const uint8_t*>(
+        MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    return data_ != nullptr;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      close(fd);
+      return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    data_ = static_cast<const uint8_t*>(data);
+    return true;
+#endif
+  }
+
+  // checks the header and that the index and every entry lie in the file
+  bool Validate() const {
+    if (size_ < sizeof(PackHeader)) return false;
+    const PackHeader* header = Header();
+    if (header->magic != kPackMagic || header->version != kPackVersion) {
+      return false;
+    }
+    if ((size_ - sizeof(PackHeader)) / sizeof(PackEntry) <
+        header->entry_count) {
+      return false;
+    }
+    for (uint32_t i = 0; i < header->entry_count; ++i) {
+      const PackEntry& entry = Entries()[i];
+      if (entry.path_offset > size_ ||
+          entry.path_length > size_ - entry.path_offset ||
+          entry.data_offset > size_ ||
+          entry.stored_size > size_ - entry.data_offset) {
+        return false;
+      }
+      // Read allocates size bytes up front, so a forged size is bounded by
+      // what the stored bytes can expand to
+      if ((entry.flags & kPackEntryLZ4) &&
+          (entry.stored_size > kMaxDecodedSize ||
+           entry.size > kMaxDecodedSize ||
+           entry.size > entry.stored_size * kMaxLZ4Ratio)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const PackEntry* Find(std::string_view path) const {
+    const PackEntry* begin = Entries();
+    const PackEntry* end = begin + Header()->entry_count;
+    auto it = std::lower_bound(begin, end, path,
+                               [this](const PackEntry& entry,
+                                      std::string_view value) {
+                                 return Path(entry) < value;
+                               });
+    if (it == end || Path(*it) != path) {
+      return nullptr;
+    }
+    return it;
+  }
+
+  VfsFile Read(const PackEntry& entry) const {
+    const uint8_t* stored = data_ + entry.data_offset;
+    if (!(entry.flags & kPackEntryLZ4)) {
+      return VfsFile(stored, entry.stored_size);
+    }
+
+    std::vector<uint8_t> bytes(entry.size);
+    int decoded = LZ4_decompress_safe(
+        reinterpret_cast<const char*>(stored),
+        reinterpret_cast<char*>(bytes.data()),
+        static_cast<int>(entry.stored_size), static_cast<int>(entry.size));
+    if (decoded < 0 || static_cast<uint64_t>(decoded) != entry.size) {
+      std::cout << "VFS: corrupted entry " << Path(entry) << std::endl;
+      return {};
+    }
+    return VfsFile(std::move(bytes));
+  }
+
+ public:
+  std::string mount_point;
+
+ private:
+  const PackHeader* Header() const {
+    return reinterpret_cast<const PackHeader*>(data_);
+  }
+  const PackEntry* Entries() const {
+    return reinterpret_cast<const PackEntry*>(data_ + sizeof(PackHeader));
+  }
+  std::string_view Path(const PackEntry& entry) const {
+    return {reinterpret_cast<const char*>(data_ + entry.path_offset),
+            entry.path_length};
+  }
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = NULL;
+#endif
+};
+
+std::vector<std::unique_ptr<MountedPack>> VirtualFileSystem::packs_;
+
+VfsFile& VfsFile::operator=(VfsFile&& other) noexcept {
+  // moving the vector keeps its buffer, so data_ stays valid
+  bytes_ = std::move(other.bytes_);
+  data_ = other.data_;
+  size_ = other.size_;
+  other.data_ = nullptr;
+  other.size_ = 0;
+  return *this;
+}
+
+// Normalizes a path to the form entries are stored in: lexically normal,
+// with forward slashes.
+static std::string NormalizePath(const std::string& path) {
+  return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+// Returns the path relative to the pack's mount point, or false if the path
+// lies outside of it.
+static bool RelativeToMountPoint(const std::string& path,
+                                 const std::string& mount_point,
+                                 std::string& relative) {
+  if (mount_point.empty()) {
+    relative = path;
+    return true;
+  }
+  if (path.size() <= mount_point.size() ||
+      path.compare(0, mount_point.size(), mount_point) != 0 ||
+      path[mount_point.size()] != '/') {
+    return false;
+  }
+  relative = path.substr(mount_point.size() + 1);
+  return true;
+}
+
+bool VirtualFileSystem::Mount(const std::string& pack_file,
+                              const std::string& mount_point) {
+  auto pack = std::make_unique<MountedPack>();
+  if (!pack->Map(pack_file)) {
+    std::cout << "VFS: failed to map " << pack_file << std::endl;
+    return false;
+  }
+  if (!pack->Validate()) {
+    std::cout << "VFS: " << pack_file << " is not a valid pack" << std::endl;
+    return false;
+  }
+
+  pack->mount_point = mount_point.empty() ? "" : NormalizePath(mount_point);
+  if (!pack->mount_point.empty() && pack->mount_point.back() == '/') {
+    pack->mount_point.pop_back();
+  }
+  packs_.push_back(std::move(pack));
+  return true;
+}
+
+void VirtualFileSystem::UnmountAll() { packs_.clear(); }
+
+bool VirtualFileSystem::Exists(const std::string& path) {
+  std::string normalized = NormalizePath(path);
+  std::string relative;
+  for (const auto& pack : packs_) {
+    if (RelativeToMountPoint(normalized, pack->mount_point, relative) &&
+        pack->Find(relative)) {
+      return true;
+    }
+  }
+  std::error_code ec;
+  return std::filesystem::is_regular_file(path, ec);
+}
+
+VfsFile VirtualFileSystem::Read(const std::string& path) {
+  std::string normalized = NormalizePath(path);
+  std::string relative;
+  for (auto it = packs_.rbegin(); it != packs_.rend(); ++it) {
+    if (!RelativeToMountPoint(normalized, (*it)->mount_point, relative)) {
+      continue;
+    }
+    if (const PackEntry* entry = (*it)->Find(relative)) {
+      return (*it)->Read(*entry);
+    }
+  }
+
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return {};
+  }
+  std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+  return VfsFile(std::move(bytes));
+}
@@ -0,0 +1,40 @@
+#include "aubengine/window_null.h"
+
+#include "aubengine/scene.h"
+
+bool WindowNull::Initialize(const std::string&, uint32_t, uint32_t) {
+  should_close_ = false;
+  return true;
+}
+void WindowNull::Close() { should_close_ = true; }
+bool WindowNull::WindowShouldClose() { return should_close_; }
+void* WindowNull::GetWindowNative() { return nullptr; }
+void* WindowNull::GetContext() { return nullptr; }
+
+void WindowNull::Begin() {}
+
+void WindowNull::End() {}
+
+void WindowNull::PhysicsUpdate() {
+  if (!scene_) {
+    return;
+  }
+
+  scene_->PhysicsUpdate();
+}
+
+void WindowNull::Update() {
+  if (!scene_) {
+    return;
+  }
+
+  scene_->Update();
+}
+void WindowNull::Render(float) {}
+
+void WindowNull::Use() {}
+void WindowNull::Release() {}
+void WindowNull::SetVSync(bool isEnabled) { v_sync_ = isEnabled; }
+bool WindowNull::GetVSync() { return v_sync_; }
+
+void WindowNull::SetScene(std::shared_ptr<Scene> scene) { scene_ = scene; }
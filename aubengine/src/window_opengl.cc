@@ -3,10 +3,12 @@
 #include <iostream>
 
 #include "aubengine/application.h"
+#include "aubengine/input_glfw.h"
 #include "aubengine/scene.h"
 
 static std::unordered_map<GLFWwindow*, WindowOpenGL*> window_to_this_;
 uint8_t WindowOpenGL::window_opengl_instances_count_ = 0;
+GLFWwindow* WindowOpenGL::share_window_ = nullptr;
 
 WindowOpenGL::~WindowOpenGL() { Close(); }
 
@@ -21,12 +23,21 @@ bool WindowOpenGL::Initialize(const std::string& title, uint32_t width,
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-  window_ = glfwCreateWindow(width, height, title.c_str(), NULL, NULL);
+  // Every window joins the share group of the first one, so textures and
+  // shader programs loaded through any context are visible to all of them.
+  window_ =
+      glfwCreateWindow(width, height, title.c_str(), NULL, share_window_);
   if (window_ == NULL) {
     std::cout << "Failed to create GLFW window" << std::endl;
     return false;
   }
 
+  window_to_this_[window_] = this;
+  ++window_opengl_instances_count_;
+  if (share_window_ == nullptr) {
+    share_window_ = window_;
+  }
+
   glfwMakeContextCurrent(window_);
   context_ = new GladGLContext();
   if (!context_) {
@@ -40,14 +51,12 @@ bool WindowOpenGL::Initialize(const std::string& title, uint32_t width,
     return false;
   }
 
-  window_to_this_[window_] = this;
-
-  ++window_opengl_instances_count_;
   glfwSetFramebufferSizeCallback(window_,
                                  [](GLFWwindow* window, int width, int height) {
-                                   glfwMakeContextCurrent(window);
                                    auto w = window_to_this_[window];
-                                   w->context_->Viewport(0, 0, width, height);
+                                   w->width_ = width;
+                                   w->height_ = height;
+                                   w->resized_ = true;
                                  });
 
   glfwSetWindowFocusCallback(window_, [](GLFWwindow* window, int focused) {
@@ -57,11 +66,35 @@ bool WindowOpenGL::Initialize(const std::string& title, uint32_t width,
     }
   });
 
+  // every window feeds input, not only the focused one
+  InputGLFW::Attach(window_);
+
   context_->Viewport(0, 0, width, height);
+  gpu_timer_.Initialize(context_);
   return true;
 }
 void WindowOpenGL::Close() {
+  if (window_ == nullptr) {
+    return;
+  }
+
+  // queries belong to this context alone, so they go with it
+  glfwMakeContextCurrent(window_);
+  gpu_timer_.Release();
+  if (scene_) {
+    scene_->ReleaseRenderResources();
+  }
+
+  window_to_this_.erase(window_);
   glfwDestroyWindow(window_);
+
+  // Shared objects live as long as any context of the group does, so any
+  // remaining window can become the one new windows share with.
+  if (share_window_ == window_) {
+    share_window_ =
+        window_to_this_.empty() ? nullptr : window_to_this_.begin()->first;
+  }
+  window_ = nullptr;
   --window_opengl_instances_count_;
 
   if (window_opengl_instances_count_ == 0) {
@@ -72,18 +105,36 @@ bool WindowOpenGL::WindowShouldClose() {
   return glfwWindowShouldClose(window_);
 }
 void* WindowOpenGL::GetWindowNative() { return window_; }
-void* WindowOpenGL::GetContext() { return context_; }
+// a closed window's context went with it
+void* WindowOpenGL::GetContext() { return window_ ? context_ : nullptr; }
 
-void WindowOpenGL::Begin() { glfwPollEvents(); }
+void WindowOpenGL::PollEvents() {
+  if (window_opengl_instances_count_ == 0) {
+    return;
+  }
+  // the callbacks queue input events from within the pump
+  glfwPollEvents();
+  InputGLFW::PollGamepads();
+}
 
-void WindowOpenGL::End() { glfwSwapBuffers(window_); }
+// events are pumped for all windows at once, by PollEvents
+void WindowOpenGL::Begin() {}
 
+void WindowOpenGL::End() {
+  AUBENGINE_PROFILE_SCOPE("WindowOpenGL::SwapBuffers");
+  if (v_sync_changed_.exchange(false)) {
+    glfwSwapInterval(v_sync_);
+  }
+  glfwSwapBuffers(window_);
+}
+
+// The simulation does no GL work (and may run on a thread that must not take
+// the context), so only Render makes the context current.
 void WindowOpenGL::PhysicsUpdate() {
   if (!scene_) {
     return;
   }
 
-  Use();
   scene_->PhysicsUpdate();
 }
 
@@ -92,28 +143,45 @@ void WindowOpenGL::Update() {
     return;
   }
 
-  Use();
   scene_->Update();
 }
-void WindowOpenGL::Render() {
+void WindowOpenGL::Render(float alpha) {
+  AUBENGINE_PROFILE_SCOPE("WindowOpenGL::Render");
   Use();
+  if (resized_.exchange(false)) {
+    context_->Viewport(0, 0, width_, height_);
+  }
+  gpu_timer_.Collect();
+  gpu_timer_.Begin("Render");
 
   context_->ClearColor(0.2f, 0.3f, 0.3f, 1.0f);
   context_->Clear(GL_COLOR_BUFFER_BIT);
   context_->BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   context_->Enable(GL_BLEND);
 
-  if (!scene_) {
-    return;
+  if (scene_) {
+    scene_->Render(alpha);
   }
 
-  scene_->Render();
+  gpu_timer_.End();
 }
 
-void WindowOpenGL::Use() { glfwMakeContextCurrent(window_); }
+// Making a context current costs a driver call even when it already is,
+// which with several windows used to be paid every phase of every frame.
+void WindowOpenGL::Use() {
+  if (glfwGetCurrentContext() != window_) {
+    glfwMakeContextCurrent(window_);
+  }
+}
+void WindowOpenGL::Release() {
+  if (glfwGetCurrentContext() == window_) {
+    glfwMakeContextCurrent(nullptr);
+  }
+}
+// the interval belongs to the context, applied by End wherever it is current
 void WindowOpenGL::SetVSync(bool isEnabled) {
   v_sync_ = isEnabled;
-  glfwSwapInterval(isEnabled);
+  v_sync_changed_ = true;
 }
 bool WindowOpenGL::GetVSync() { return v_sync_; }
 
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "network/message.h"
+#include "network/queue_thread_safe.h"
+
+namespace {
+enum class BenchmarkMessage : uint32_t {
+  kState,
+};
+
+struct EntityState {
+  uint32_t id = 0;
+  float x = 0;
+  float y = 0;
+};
+}  // namespace
+
+static void BM_MessageWrite(benchmark::State& state) {
+  EntityState entity{1, 2.0f, 3.0f};
+  for (auto _ : state) {
+    Message<BenchmarkMessage> message;
+    message.Header.ID = BenchmarkMessage::kState;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      message.Write(entity);
+    }
+    benchmark::DoNotOptimize(message.Body.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          sizeof(EntityState));
+}
+BENCHMARK(BM_MessageWrite)->RangeMultiplier(8)->Range(1, 512);
+
+static void BM_MessageRead(benchmark::State& state) {
+  Message<BenchmarkMessage> written;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    written.Write(EntityState{uint32_t(i), 2.0f, 3.0f});
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    Message<BenchmarkMessage> message = written;
+    state.ResumeTiming();
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      benchmark::DoNotOptimize(message.Read<EntityState>());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          sizeof(EntityState));
+}
+BENCHMARK(BM_MessageRead)->RangeMultiplier(8)->Range(8, 512);
+
+static void BM_MessageWriteVector(benchmark::State& state) {
+  std::vector<EntityState> entities(state.range(0));
+  for (auto _ : state) {
+    Message<BenchmarkMessage> message;
+    message.WriteVector(entities);
+    benchmark::DoNotOptimize(message.Body.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          sizeof(EntityState));
+}
+BENCHMARK(BM_MessageWriteVector)->RangeMultiplier(8)->Range(8, 512);
+
+// Every thread pushes then pops, so the queue never runs dry under a pop
+// while all threads fight over its lock.
+static void BM_QueuePushPop(benchmark::State& state) {
+  static QueueThreadSafe<Message<BenchmarkMessage>> queue;
+  Message<BenchmarkMessage> message;
+  message.Write(EntityState{});
+
+  for (auto _ : state) {
+    queue.PushBack(message);
+    benchmark::DoNotOptimize(queue.PopFront());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueuePushPop)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "aubengine/application.h"
+#include "aubengine/components/box_collider_2d.h"
+#include "aubengine/components/rigid_body_2d.h"
+#include "aubengine/components/transform.h"
+#include "aubengine/game_object.h"
+#include "aubengine/scene.h"
+
+namespace {
+class Crate : public GameObject {
+ public:
+  Crate(Scene* scene) : GameObject("Crate", scene) {
+    transform_ = AddComponent<Transform>();
+  }
+
+  void Place(float x, float y, float width, RigidBody2D::BodyType type) {
+    transform_->position = {x, y, 0};
+    transform_->size = {width, 1, 1};
+    AddComponent<RigidBody2D>(type);
+    AddComponent<BoxCollider2D>();
+  }
+
+ private:
+  Transform* transform_ = nullptr;
+};
+}  // namespace
+
+// A full tick of N boxes piling up on a static floor, through the
+// components the way the main loop drives them.
+static void BM_PhysicsStep(benchmark::State& state) {
+  Aubengine::Application::GetInstance().SetUpdateRate(60);
+
+  Scene scene(nullptr, nullptr);
+  Crate* floor = scene.Instantiate<Crate>();
+  floor->Place(0, -1, 1000, RigidBody2D::BodyType::kStatic);
+
+  int64_t count = state.range(0);
+  int64_t columns = 100;
+  for (int64_t i = 0; i < count; ++i) {
+    Crate* crate = scene.Instantiate<Crate>();
+    crate->Place(float(i % columns) * 1.5f - columns * 0.75f,
+                 float(i / columns) * 1.5f + 1.0f, 1,
+                 RigidBody2D::BodyType::kDynamic);
+  }
+
+  // the step a tick starts runs while the next tick's PhysicsUpdate waits
+  // for it, so a full tick is both halves
+  for (auto _ : state) {
+    scene.PhysicsUpdate();
+    scene.Update();
+  }
+  scene.GetPhysicsWorld().EndStep();
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_PhysicsStep)->RangeMultiplier(4)->Range(16, 4096);
+
+// Spawning N boxes, giving their bodies a step to join the broadphase, and
+// destroying them all at once, as a wave of pooled-out objects would.
+static void BM_PhysicsSpawnDestroy(benchmark::State& state) {
+  Aubengine::Application::GetInstance().SetUpdateRate(60);
+
+  Scene scene(nullptr, nullptr);
+  int64_t count = state.range(0);
+  int64_t columns = 100;
+  std::vector<GameObject*> crates;
+  crates.reserve(count);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < count; ++i) {
+      Crate* crate = scene.Instantiate<Crate>();
+      crate->Place(float(i % columns) * 1.5f, float(i / columns) * 1.5f, 1,
+                   RigidBody2D::BodyType::kDynamic);
+      crates.push_back(crate);
+    }
+    scene.Update();
+    scene.PhysicsUpdate();
+    scene.Destroy(crates);
+    crates.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_PhysicsSpawnDestroy)->RangeMultiplier(4)->Range(16, 4096);
+
+// Going back 8 ticks and running them again, as a rollback on a late input
+// does, over N boxes piling up; this has to fit well within a tick.
+static void BM_PhysicsRollback(benchmark::State& state) {
+  Aubengine::Application::GetInstance().SetUpdateRate(60);
+
+  Scene scene(nullptr, nullptr);
+  scene.SetSnapshotHistory(16);
+  Crate* floor = scene.Instantiate<Crate>();
+  floor->Place(0, -1, 1000, RigidBody2D::BodyType::kStatic);
+
+  int64_t count = state.range(0);
+  int64_t columns = 100;
+  for (int64_t i = 0; i < count; ++i) {
+    Crate* crate = scene.Instantiate<Crate>();
+    crate->Place(float(i % columns) * 1.5f - columns * 0.75f,
+                 float(i / columns) * 1.5f + 1.0f, 1,
+                 RigidBody2D::BodyType::kDynamic);
+  }
+  for (int i = 0; i < 16; ++i) {
+    scene.PhysicsUpdate();
+    scene.Update();
+  }
+
+  for (auto _ : state) {
+    scene.Rollback(scene.GetTick() - 8);
+    for (int i = 0; i < 8; ++i) {
+      scene.PhysicsUpdate();
+      scene.Update();
+    }
+  }
+  scene.GetPhysicsWorld().EndStep();
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_PhysicsRollback)->RangeMultiplier(4)->Range(16, 4096);
@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include "aubengine/application.h"
+#include "aubengine/components/transform.h"
+#include "aubengine/game_object.h"
+#include "aubengine/scene.h"
+
+namespace {
+class BenchmarkObject : public GameObject {
+ public:
+  BenchmarkObject(Scene* scene) : GameObject("Benchmark", scene) {
+    AddComponent<Transform>();
+  }
+};
+
+// distinct component types, so lookups have to skip past the others
+template <int N>
+class Padding : public Component {};
+class Target : public Component {};
+}  // namespace
+
+static void BM_SceneUpdate(benchmark::State& state) {
+  // the physics step lasts one tick
+  Aubengine::Application::GetInstance().SetUpdateRate(60);
+  Scene scene(nullptr, nullptr);
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    scene.Instantiate<BenchmarkObject>();
+  }
+
+  for (auto _ : state) {
+    scene.PhysicsUpdate();
+    scene.Update();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SceneUpdate)->RangeMultiplier(8)->Range(64, 32768);
+
+static void BM_GetComponent(benchmark::State& state) {
+  Scene scene(nullptr, nullptr);
+  GameObject* go = scene.Instantiate<BenchmarkObject>();
+  go->AddComponent<Padding<0>>();
+  go->AddComponent<Padding<1>>();
+  go->AddComponent<Padding<2>>();
+  go->AddComponent<Padding<3>>();
+  go->AddComponent<Padding<4>>();
+  go->AddComponent<Padding<5>>();
+  go->AddComponent<Padding<6>>();
+  go->AddComponent<Target>();
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(go->GetComponent<Target>());
+  }
+}
+BENCHMARK(BM_GetComponent);
+
+static void BM_GetComponentMissing(benchmark::State& state) {
+  Scene scene(nullptr, nullptr);
+  GameObject* go = scene.Instantiate<BenchmarkObject>();
+  go->AddComponent<Padding<0>>();
+  go->AddComponent<Padding<1>>();
+  go->AddComponent<Padding<2>>();
+  go->AddComponent<Padding<3>>();
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(go->GetComponent<Target>());
+  }
+}
+BENCHMARK(BM_GetComponentMissing);
@@ -0,0 +1,112 @@
+// clang-format off
+#include <glad/gl.h>
+// clang-format on
+#include <GLFW/glfw3.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "aubengine/shader.h"
+#include "aubengine/sprite_renderer.h"
+#include "aubengine/texture_2d.h"
+
+static const char* kVertexSource = R"(#version 330 core
+layout (location = 0) in vec2 attrPosition;
+layout (location = 1) in vec2 attrTexCoords;
+out vec2 texCoords;
+uniform mat4 model;
+uniform mat4 projection;
+void main() {
+  texCoords = attrTexCoords;
+  gl_Position = projection * model * vec4(attrPosition, 0.0, 1.0);
+})";
+
+static const char* kFragmentSource = R"(#version 330 core
+in vec2 texCoords;
+out vec4 color;
+uniform sampler2D image;
+uniform vec3 spriteColor;
+void main() {
+  color = vec4(spriteColor, 1.0) * texture(image, texCoords);
+})";
+
+// An invisible window, so submission runs against a real driver without
+// putting anything on screen. Machines without a display skip the
+// benchmark rather than fail the run.
+class HiddenContext {
+ public:
+  HiddenContext() {
+    if (!glfwInit()) {
+      return;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    window_ = glfwCreateWindow(800, 600, "benchmarks", NULL, NULL);
+    if (window_ == NULL) {
+      return;
+    }
+    glfwMakeContextCurrent(window_);
+    glfwSwapInterval(0);
+    context_ = std::make_unique<GladGLContext>();
+    if (gladLoadGLContext(context_.get(), glfwGetProcAddress) == 0) {
+      context_.reset();
+    }
+  }
+  ~HiddenContext() {
+    if (window_ != NULL) {
+      glfwDestroyWindow(window_);
+    }
+    glfwTerminate();
+  }
+
+  GladGLContext* Get() { return context_.get(); }
+
+ private:
+  GLFWwindow* window_ = NULL;
+  std::unique_ptr<GladGLContext> context_;
+};
+
+static void BM_SpriteRendererSubmit(benchmark::State& state) {
+  HiddenContext hidden;
+  GladGLContext* context = hidden.Get();
+  if (context == nullptr) {
+    state.SkipWithError("no OpenGL context available");
+    return;
+  }
+
+  auto shader = std::make_shared<Shader>(context);
+  shader->Compile(kVertexSource, kFragmentSource);
+  auto texture = std::make_shared<Texture2D>(context);
+  unsigned char white[] = {255, 255, 255};
+  texture->Generate(1, 1, white);
+
+  std::vector<SpriteRenderState> sprites(state.range(0));
+  for (size_t i = 0; i < sprites.size(); ++i) {
+    SpriteRenderState& sprite = sprites[i];
+    sprite.shader = shader;
+    sprite.texture = texture;
+    sprite.context = context;
+    sprite.position = {float(i % 40) * 20, float(i / 40 % 30) * 20, 0};
+    sprite.previous_position = sprite.position;
+    sprite.size = {16, 16, 1};
+  }
+
+  SpriteRenderer renderer;
+  for (auto _ : state) {
+    for (const auto& sprite : sprites) {
+      renderer.DrawSprite(sprite, 1.0f);
+    }
+    // waits for the GPU, so queued work is not carried into the next
+    // iteration's timing
+    context->Finish();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+
+  texture->Release();
+  context->DeleteProgram(shader->id);
+}
+BENCHMARK(BM_SpriteRendererSubmit)->RangeMultiplier(4)->Range(64, 16384);
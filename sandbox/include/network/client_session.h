@@ -3,6 +3,7 @@
 #include <asio.hpp>
 
 #include "network/message.h"
+#include "network/net_metrics.h"
 #include "network/queue_thread_safe.h"
 
 template <typename T>
@@ -29,6 +30,7 @@ class ClientSession : public std::enable_shared_from_this<ClientSession<T>> {
     asio::post(_asioContext, [this, msg]() {
       bool isWritingMessage = !messages_out_.Empty();
       messages_out_.PushBack(msg);
+      NetMetrics::Sent(messages_out_.Size());
       if (!isWritingMessage) {
         DoWriteTCPHeader();
       }
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "aubengine/metrics.h"
+
+// Traffic counters shared by every client, server and session.
+class NetMetrics {
+ public:
+  // called as a batch of incoming messages is handled, with the depth the
+  // incoming queue had before it
+  static void Received(size_t count, size_t incomingDepth) {
+    static MetricCounter& messagesIn = Metrics::GetCounter("net.messages_in");
+    static MetricGauge& depth = Metrics::GetGauge("net.incoming_queue_depth");
+    messagesIn.Add(count);
+    depth.Set(double(incomingDepth));
+  }
+
+  // called as a message is queued for sending
+  static void Sent(size_t outgoingDepth) {
+    static MetricCounter& messagesOut =
+        Metrics::GetCounter("net.messages_out");
+    static MetricGauge& depth = Metrics::GetGauge("net.outgoing_queue_depth");
+    messagesOut.Add();
+    depth.Set(double(outgoingDepth));
+  }
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "network/delegate.h"
+#include "network/net_metrics.h"
 
 // Client
 template <typename T>
@@ -57,6 +58,7 @@ class TCPClient {
       messages_in_.Wait();
     }
 
+    size_t depth = messages_in_.Size();
     // Process as many messages as you can up to the value
     // specified
     size_t messageCount = 0;
@@ -69,12 +71,14 @@ class TCPClient {
 
       messageCount++;
     }
+    NetMetrics::Received(messageCount, depth);
   }
 
   void Send(const Message<T>& msg) {
     asio::post(_asioContext, [this, msg]() {
       bool bWritingMessage = !messages_out_.Empty();
       messages_out_.PushBack(msg);
+      NetMetrics::Sent(messages_out_.Size());
       if (!bWritingMessage) {
         DoWriteHeader();
       }
@@ -2,6 +2,7 @@
 
 #include "network/client_session.h"
 #include "network/delegate.h"
+#include "network/net_metrics.h"
 
 template <typename T>
 class TCPServer {
@@ -122,6 +123,7 @@ class TCPServer {
       messages_in_.Wait();
     }
 
+    size_t depth = messages_in_.Size();
     // Process as many messages as you can up to the value
     // specified
     size_t messageCount = 0;
@@ -134,6 +136,7 @@ class TCPServer {
 
       ++messageCount;
     }
+    NetMetrics::Received(messageCount, depth);
   }
 
  public:
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "network/net_metrics.h"
+
 // Client
 template <typename T>
 class UDPClient {
@@ -56,6 +58,7 @@ class UDPClient {
       messages_in_.Wait();
     }
 
+    size_t depth = messages_in_.Size();
     // Process as many messages as you can up to the value
     // specified
     size_t messageCount = 0;
@@ -68,12 +71,14 @@ class UDPClient {
 
       messageCount++;
     }
+    NetMetrics::Received(messageCount, depth);
   }
 
   void Send(const Message<T>& msg) {
     asio::post(_asioContext, [this, msg]() {
       bool bWritingMessage = !messages_out_.Empty();
       messages_out_.PushBack(msg);
+      NetMetrics::Sent(messages_out_.Size());
       if (!bWritingMessage) {
         DoSend();
       }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "network/delegate.h"
+#include "network/net_metrics.h"
 #include "network/message.h"
 #include "network/queue_thread_safe.h"
 
@@ -40,6 +41,7 @@ class UDPServer {
     asio::post(_asioContext, [this, msg]() {
       bool isWritingMessage = !messages_out_.Empty();
       messages_out_.PushBack(msg);
+      NetMetrics::Sent(messages_out_.Size());
       if (!isWritingMessage) {
         DoSend();
       }
@@ -88,6 +90,7 @@ class UDPServer {
       messages_in_.Wait();
     }
 
+    size_t depth = messages_in_.Size();
     // Process as many messages as you can up to the value
     // specified
     size_t messageCount = 0;
@@ -100,6 +103,7 @@ class UDPServer {
 
       ++messageCount;
     }
+    NetMetrics::Received(messageCount, depth);
   }
 
  public:
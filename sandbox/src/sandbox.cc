@@ -2,6 +2,7 @@
 #include <filesystem>
 #include <iostream>
 #include <limits>
+#include <string>
 #include <unordered_map>
 
 #include "aubengine/application.h"
@@ -10,14 +11,29 @@
 #include "aubengine/components/transform.h"
 #include "aubengine/game_object.h"
 #include "aubengine/input.h"
+#include "aubengine/metrics.h"
 #include "aubengine/prefab.h"
+#include "aubengine/profiler.h"
 #include "aubengine/resource_manager.h"
 #include "aubengine/scene.h"
 #include "aubengine/shader.h"
 #include "aubengine/sprite_renderer.h"
+#include "aubengine/vfs.h"
 #include "network/net.h"
 
 bool isServer = true;
+// dedicated server mode: no window, no OpenGL
+bool isHeadless = false;
+bool isThreaded = false;
+// each window renders from a thread of its own
+bool isRenderThreaded = false;
+// records zones and writes them to sandbox_trace.json on exit
+bool isProfiled = false;
+// reloads shaders and textures when their files change
+bool isHotReloaded = false;
+// input log to write, or to play back instead of live input
+std::string recordPath;
+std::string replayPath;
 
 class FPS {
  protected:
@@ -96,6 +112,17 @@ class MovementManager : public Component {
   Entity* entity_ = nullptr;
 };
 
+// ends the run once a replayed input log is exhausted, so replays of
+// headless sessions terminate
+class ReplayWatcher : public Component {
+ public:
+  void Update() override {
+    if (Input::IsReplayFinished()) {
+      Aubengine::Application::GetInstance().Quit();
+    }
+  }
+};
+
 class PlayerPaddlePrefab : public GameObject {
  public:
   PlayerPaddlePrefab(Scene* scene) : GameObject("PlayerPaddle", scene) {
@@ -505,11 +532,22 @@ class NetworkServerPrefab : public GameObject {
   }
 };
 
+class ReplayWatcherPrefab : public GameObject {
+ public:
+  ReplayWatcherPrefab(Scene* scene) : GameObject("ReplayWatcher", scene) {
+    AddComponent<ReplayWatcher>();
+  }
+};
+
 class MainScene : public Scene {
  public:
   MainScene(Window* window, SpriteRenderer* renderer)
       : Scene(window, renderer) {
     auto ctx = static_cast<GladGLContext*>(window->GetContext());
+    // assets come from a pack built by the packer tool when one is present
+    if (std::filesystem::exists("assets.pack")) {
+      VirtualFileSystem::Mount("assets.pack", "../../aubengine/src");
+    }
     ResourceManager::LoadShader("../../aubengine/src/shaders/default.vs.glsl",
                                 "../../aubengine/src/shaders/default.fs.glsl",
                                 "default", ctx);
@@ -517,6 +555,11 @@ class MainScene : public Scene {
                                  false, "block", ctx);
     ResourceManager::LoadTexture("../../aubengine/src/textures/paddle.png",
                                  true, "paddle", ctx);
+    ResourceManager::EnableHotReload(isHotReloaded);
+
+    if (!replayPath.empty()) {
+      Instantiate<ReplayWatcherPrefab>();
+    }
 
     if (isServer) {
       networkServer = Instantiate<NetworkServerPrefab>();
@@ -538,7 +581,7 @@ class MainScene : public Scene {
 void TesterInitializer() {
   auto& app = Aubengine::Application::GetInstance();
 
-  auto window1 = app.CreateWindowOpenGL();
+  auto window1 = isHeadless ? app.CreateWindowNull() : app.CreateWindowOpenGL();
   window1->Initialize("First", 800, 600);
   window1->SetVSync(true);
 
@@ -569,8 +612,37 @@ int main(int argc, char* argv[]) {
       isServer = true;
     }
   }
+  for (int i = 2; i < argc; ++i) {
+    if (strcmp(argv[i], "headless") == 0) {
+      isHeadless = true;
+    } else if (strcmp(argv[i], "threaded") == 0) {
+      isThreaded = true;
+    } else if (strcmp(argv[i], "renderthreads") == 0) {
+      isRenderThreaded = true;
+    } else if (strcmp(argv[i], "profile") == 0) {
+      isProfiled = true;
+    } else if (strcmp(argv[i], "hotreload") == 0) {
+      isHotReloaded = true;
+    } else if (strcmp(argv[i], "record") == 0 && i + 1 < argc) {
+      recordPath = argv[++i];
+    } else if (strcmp(argv[i], "replay") == 0 && i + 1 < argc) {
+      replayPath = argv[++i];
+    }
+  }
 
+  Profiler::SetEnabled(isProfiled);
   TesterInitializer();
+  Aubengine::Application::GetInstance()
+      .SetThreadedSimulation(isThreaded)
+      .SetRenderThreads(isRenderThreaded);
+  if (!replayPath.empty() && !Input::StartReplay(replayPath)) {
+    std::cout << "Could not open input log " << replayPath << "\n";
+    return 1;
+  }
+  if (!recordPath.empty() && !Input::StartRecording(recordPath)) {
+    std::cout << "Could not create input log " << recordPath << "\n";
+    return 1;
+  }
 
   if (isServer) {
     Aubengine::Application::GetInstance().SetUpdateRate(50).Run();
@@ -578,5 +650,12 @@ int main(int argc, char* argv[]) {
     Aubengine::Application::GetInstance().SetUpdateRate(60).Run();
   }
 
+  Input::StopRecording();
+  if (isProfiled) {
+    Profiler::ExportChromeTrace("sandbox_trace.json");
+  }
+  Metrics::DumpCsv(isServer ? "sandbox_server_metrics.csv"
+                            : "sandbox_client_metrics.csv");
+
   return 0;
 }
@@ -0,0 +1,257 @@
+// Headless stress harness: spawns N blocks like the sandbox's BlockPrefab,
+// each with a sprite, a dynamic rigid body and a box collider, runs a fixed
+// number of ticks on the null backend and reports the time spent in each
+// phase of the tick along with the memory the objects take, then destroys
+// them all at once.
+//
+//   stress <objects> [ticks] [--static] [--csv <file>]
+//
+// With --static the blocks are static objects on static bodies, as level
+// geometry would be, so their sprites are baked instead of captured.
+//
+// With --csv one row per run is appended to the file, so sweeps such as
+//   for n in 1000 10000 100000 1000000; do stress $n 300 --csv s.csv; done
+// build a table of how each phase scales.
+
+#ifdef _WIN32
+#include <windows.h>
+// windows.h must come first
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "aubengine/application.h"
+#include "aubengine/components/box_collider_2d.h"
+#include "aubengine/components/rigid_body_2d.h"
+#include "aubengine/components/sprite_renderer_2d.h"
+#include "aubengine/components/transform.h"
+#include "aubengine/game_object.h"
+#include "aubengine/metrics.h"
+#include "aubengine/scene.h"
+#include "aubengine/shader.h"
+#include "aubengine/texture_2d.h"
+
+// resident set size of the process, in bytes
+static uint64_t ResidentBytes() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                           sizeof(counters))) {
+    return counters.WorkingSetSize;
+  }
+  return 0;
+#elif defined(__linux__)
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size = 0;
+  uint64_t resident = 0;
+  statm >> size >> resident;
+  return resident * uint64_t(sysconf(_SC_PAGESIZE));
+#else
+  // only the peak is available portably, which still grows with the spawn
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return uint64_t(usage.ru_maxrss);
+#endif
+}
+
+class StressBlock : public GameObject {
+ public:
+  StressBlock(Scene* scene) : GameObject("Block", scene) {
+    AddComponent<Transform>();
+  }
+
+  void Place(float x, float y, glm::vec3 size, RigidBody2D::BodyType type,
+             std::shared_ptr<Shader> shader,
+             std::shared_ptr<Texture2D> texture) {
+    transform->position = {x, y, 0};
+    transform->size = size;
+    AddComponent<SpriteRenderer2D>(shader, texture);
+    AddComponent<RigidBody2D>(type);
+    AddComponent<BoxCollider2D>();
+  }
+};
+
+// per-tick durations of one phase, in milliseconds
+struct Phase {
+  const char* name;
+  std::vector<double> samples;
+
+  double Mean() const {
+    double sum = 0;
+    for (double sample : samples) {
+      sum += sample;
+    }
+    return samples.empty() ? 0 : sum / samples.size();
+  }
+  double Percentile(double p) const {
+    if (samples.empty()) {
+      return 0;
+    }
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[size_t(p * (sorted.size() - 1) + 0.5)];
+  }
+};
+
+template <typename F>
+static double TimeMilliseconds(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cout
+        << "Usage: stress <objects> [ticks] [--static] [--csv <file>]\n";
+    return 1;
+  }
+
+  uint64_t objects = std::strtoull(argv[1], nullptr, 10);
+  uint64_t ticks = 600;
+  std::string csv;
+  bool staticBlocks = false;
+  for (int i = 2; i < argc; ++i) {
+    if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+      csv = argv[++i];
+    } else if (strcmp(argv[i], "--static") == 0) {
+      staticBlocks = true;
+    } else {
+      ticks = std::strtoull(argv[i], nullptr, 10);
+    }
+  }
+
+  auto& app = Aubengine::Application::GetInstance();
+  app.SetUpdateRate(60);
+  Window* window = app.CreateWindowNull();
+  window->Initialize("Stress", 800, 600);
+  SpriteRenderer renderer;
+  auto scene = std::make_shared<Scene>(window, &renderer);
+  window->SetScene(scene);
+
+  // without a context these are placeholders that never touch the GPU
+  auto shader = std::make_shared<Shader>(nullptr);
+  auto texture = std::make_shared<Texture2D>(nullptr);
+
+  // blocks 32 units wide on a 40 unit grid, in a square, over a floor
+  uint64_t columns = 1;
+  while (columns * columns < objects) {
+    ++columns;
+  }
+  StressBlock* floor = scene->Instantiate<StressBlock>();
+  floor->SetStatic(true);
+  floor->Place(columns * 20.0f, -20, {columns * 40.0f + 400, 20, 1},
+               RigidBody2D::BodyType::kStatic, shader, texture);
+
+  std::vector<GameObject*> blocks;
+  blocks.reserve(objects);
+  uint64_t residentBefore = ResidentBytes();
+  double spawnMilliseconds = TimeMilliseconds([&]() {
+    scene->GetPhysicsWorld().Reserve(objects + 1);
+    for (uint64_t i = 0; i < objects; ++i) {
+      StressBlock* block = scene->Instantiate<StressBlock>();
+      block->SetStatic(staticBlocks);
+      block->Place(float(i % columns) * 40.0f, float(i / columns) * 40.0f,
+                   {128 / 4.0, 128 / 4.0, 1},
+                   staticBlocks ? RigidBody2D::BodyType::kStatic
+                                : RigidBody2D::BodyType::kDynamic,
+                   shader, texture);
+      blocks.push_back(block);
+    }
+  });
+  uint64_t residentAfterSpawn = ResidentBytes();
+
+  Phase input{"input", {}};
+  Phase physics{"physics", {}};
+  Phase update{"update", {}};
+  Phase capture{"render capture", {}};
+  Phase tick{"tick", {}};
+  for (uint64_t i = 0; i < ticks; ++i) {
+    double total = 0;
+    total += input.samples.emplace_back(
+        TimeMilliseconds([&]() { app.PollInput(); }));
+    total += physics.samples.emplace_back(
+        TimeMilliseconds([&]() { app.PhysicsUpdate(); }));
+    total += update.samples.emplace_back(
+        TimeMilliseconds([&]() { app.Update(); }));
+    // what a renderer would consume, captured even though the null backend
+    // draws nothing
+    total += capture.samples.emplace_back(
+        TimeMilliseconds([&]() { scene->PublishRenderState(); }));
+    tick.samples.push_back(total);
+    Metrics::EndFrame();
+  }
+  uint64_t residentAfterRun = ResidentBytes();
+  double despawnMilliseconds =
+      TimeMilliseconds([&]() { scene->Destroy(blocks); });
+
+  // The step runs on the physics thread, overlapped with the rest of the
+  // tick, so the physics phase only shows the part that was waited for;
+  // this is the step itself, over the last 1024 ticks.
+  HistogramSummary step =
+      Metrics::GetHistogram("physics.step_ms").Summarize();
+
+  double spawnedBytes = double(residentAfterSpawn) - double(residentBefore);
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "objects: " << objects << ", ticks: " << ticks << "\n";
+  std::cout << "spawn: " << spawnMilliseconds << " ms, resident +"
+            << spawnedBytes / (1024.0 * 1024.0) << " MiB ("
+            << (objects ? spawnedBytes / objects : 0) << " bytes/object)\n";
+  std::cout << "resident after run: "
+            << residentAfterRun / (1024.0 * 1024.0) << " MiB\n";
+  std::cout << "despawn: " << despawnMilliseconds << " ms\n\n";
+  std::cout << std::left << std::setw(16) << "phase" << std::right
+            << std::setw(12) << "mean ms" << std::setw(12) << "p50 ms"
+            << std::setw(12) << "p99 ms" << std::setw(12) << "max ms"
+            << "\n";
+  for (const Phase* phase : {&input, &physics, &update, &capture, &tick}) {
+    std::cout << std::left << std::setw(16) << phase->name << std::right
+              << std::setw(12) << phase->Mean() << std::setw(12)
+              << phase->Percentile(0.5) << std::setw(12)
+              << phase->Percentile(0.99) << std::setw(12)
+              << phase->Percentile(1.0) << "\n";
+  }
+  std::cout << std::left << std::setw(16) << "  world step" << std::right
+            << std::setw(12) << step.mean << std::setw(12) << step.p50
+            << std::setw(12) << step.p99 << std::setw(12) << step.max
+            << "\n";
+
+  if (!csv.empty()) {
+    bool exists = std::ifstream(csv).good();
+    std::ofstream out(csv, std::ios::app);
+    if (!exists) {
+      out << "objects,ticks,spawn_ms,spawn_bytes,resident_bytes";
+      for (const Phase* phase :
+           {&input, &physics, &update, &capture, &tick}) {
+        std::string name = phase->name;
+        std::replace(name.begin(), name.end(), ' ', '_');
+        out << "," << name << "_mean_ms," << name << "_p99_ms";
+      }
+      out << ",step_mean_ms,step_p99_ms,despawn_ms\n";
+    }
+    out << objects << "," << ticks << "," << spawnMilliseconds << ","
+        << uint64_t(std::max(0.0, spawnedBytes)) << "," << residentAfterRun;
+    for (const Phase* phase : {&input, &physics, &update, &capture, &tick}) {
+      out << "," << phase->Mean() << "," << phase->Percentile(0.99);
+    }
+    out << "," << step.mean << "," << step.p99 << ","
+        << despawnMilliseconds << "\n";
+  }
+
+  return 0;
+}
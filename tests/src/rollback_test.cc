@@ -0,0 +1,91 @@
+// Rolls a scene back over components added and removed after the snapshot,
+// which must neither receive another component's state nor lose their own.
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "aubengine/application.h"
+#include "aubengine/components/component.h"
+#include "aubengine/game_object.h"
+#include "aubengine/scene.h"
+#include "aubengine/snapshot.h"
+
+class Counter : public Component {
+ public:
+  explicit Counter(int32_t value) : value(value) {}
+
+  virtual void SaveState(SnapshotWriter& writer) const override {
+    writer.Write(value);
+  }
+  virtual void LoadState(SnapshotReader& reader) override {
+    reader.Read(value);
+  }
+
+  int32_t value = 0;
+};
+
+class Holder : public GameObject {
+ public:
+  Holder(Scene* scene) : GameObject("Holder", scene) {
+    AddComponent<Transform>();
+  }
+};
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+  if (!condition) {
+    std::cout << "FAILED: " << what << "\n";
+    ++failures;
+  }
+}
+
+int main() {
+  auto& app = Aubengine::Application::GetInstance();
+  app.SetUpdateRate(60);
+  Window* window = app.CreateWindowNull();
+  window->Initialize("Rollback test", 800, 600);
+  SpriteRenderer renderer;
+  auto scene = std::make_shared<Scene>(window, &renderer);
+  window->SetScene(scene);
+  scene->SetSnapshotHistory(8);
+
+  Holder* holder = scene->Instantiate<Holder>();
+  std::vector<Counter*> before;
+  for (int32_t i = 0; i < 8; ++i) {
+    before.push_back(holder->AddComponent<Counter>(i));
+  }
+  // the snapshot of tick 1 is taken at its start
+  scene->PhysicsUpdate();
+  uint64_t tick = scene->GetTick();
+
+  // enough new components to rehash the set more than once
+  std::vector<Counter*> after;
+  for (int32_t i = 0; i < 64; ++i) {
+    after.push_back(holder->AddComponent<Counter>(-1));
+  }
+  holder->RemoveComponent(before[3]);
+  before.erase(before.begin() + 3);
+  for (Counter* counter : before) {
+    counter->value = 100;
+  }
+
+  Expect(scene->Rollback(tick), "the tick is held");
+  const int32_t expected[] = {0, 1, 2, 4, 5, 6, 7};
+  for (size_t i = 0; i < before.size(); ++i) {
+    Expect(before[i]->value == expected[i],
+           "components from before the snapshot get their own state back");
+  }
+  for (Counter* counter : after) {
+    Expect(counter->value == -1,
+           "components added since the snapshot keep their state");
+  }
+
+  if (failures != 0) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "rollback_test passed\n";
+  return EXIT_SUCCESS;
+}
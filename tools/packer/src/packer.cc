@@ -0,0 +1,132 @@
+// Offline asset packer: bundles every file under a directory into a single
+// pack that VirtualFileSystem mounts with one memory map.
+//
+//   packer <input directory> <output pack> [--lz4]
+//
+// With --lz4 each entry is LZ4 HC compressed, and kept stored whenever
+// compression does not make it smaller (already compressed images usually).
+
+#include <lz4.h>
+#include <lz4hc.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "aubengine/pack_file.h"
+
+struct InputFile {
+  std::string path;
+  std::vector<uint8_t> data;
+  uint64_t size = 0;
+  uint32_t flags = 0;
+};
+
+static bool ReadFile(const std::filesystem::path& path,
+                     std::vector<uint8_t>& data) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+  data.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(data.data()), data.size());
+  return static_cast<bool>(file);
+}
+
+static void Compress(InputFile& file) {
+  int bound = LZ4_compressBound(static_cast<int>(file.data.size()));
+  std::vector<uint8_t> compressed(bound);
+  int compressedSize = LZ4_compress_HC(
+      reinterpret_cast<const char*>(file.data.data()),
+      reinterpret_cast<char*>(compressed.data()),
+      static_cast<int>(file.data.size()), bound, LZ4HC_CLEVEL_MAX);
+  if (compressedSize > 0 &&
+      static_cast<size_t>(compressedSize) < file.data.size()) {
+    compressed.resize(compressedSize);
+    file.data = std::move(compressed);
+    file.flags |= kPackEntryLZ4;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cout << "Usage: packer <input directory> <output pack> [--lz4]\n";
+    return 1;
+  }
+  std::filesystem::path root = argv[1];
+  std::string output = argv[2];
+  bool lz4 = argc > 3 && strcmp(argv[3], "--lz4") == 0;
+
+  std::vector<InputFile> files;
+  for (const auto& it : std::filesystem::recursive_directory_iterator(root)) {
+    if (!it.is_regular_file()) {
+      continue;
+    }
+    InputFile file;
+    file.path = std::filesystem::relative(it.path(), root).generic_string();
+    if (!ReadFile(it.path(), file.data)) {
+      std::cout << "Failed to read " << it.path() << "\n";
+      return 1;
+    }
+    file.size = file.data.size();
+    if (lz4 && !file.data.empty()) {
+      Compress(file);
+    }
+    files.push_back(std::move(file));
+  }
+
+  // the runtime binary searches the index, so it must be sorted by path
+  std::sort(files.begin(), files.end(),
+            [](const InputFile& a, const InputFile& b) {
+              return a.path < b.path;
+            });
+
+  PackHeader header;
+  header.entry_count = static_cast<uint32_t>(files.size());
+
+  std::vector<PackEntry> entries(files.size());
+  uint64_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+  for (size_t i = 0; i < files.size(); ++i) {
+    entries[i].path_offset = offset;
+    entries[i].path_length = static_cast<uint32_t>(files[i].path.size());
+    offset += files[i].path.size();
+  }
+  for (size_t i = 0; i < files.size(); ++i) {
+    entries[i].data_offset = offset;
+    entries[i].stored_size = files[i].data.size();
+    entries[i].size = files[i].size;
+    entries[i].flags = files[i].flags;
+    offset += files[i].data.size();
+  }
+
+  std::ofstream pack(output, std::ios::binary);
+  pack.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  pack.write(reinterpret_cast<const char*>(entries.data()),
+             entries.size() * sizeof(PackEntry));
+  for (const auto& file : files) {
+    pack.write(file.path.data(), file.path.size());
+  }
+  for (const auto& file : files) {
+    pack.write(reinterpret_cast<const char*>(file.data.data()),
+               file.data.size());
+  }
+  if (!pack) {
+    std::cout << "Failed to write " << output << "\n";
+    return 1;
+  }
+
+  uint64_t stored = 0;
+  uint64_t original = 0;
+  for (const auto& file : files) {
+    stored += file.data.size();
+    original += file.size;
+  }
+  std::cout << "Packed " << files.size() << " files, " << original
+            << " bytes into " << stored << " bytes of data\n";
+  return 0;
+}